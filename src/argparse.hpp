@@ -8,16 +8,71 @@
 #include <cstdio>
 
 struct Args {
-    std::string pluginPath;
-    double sampleRate = 48000.0;
-    int channels = 2;
-    std::string bitDepth = "32f"; // 32f, 64f
+    std::string pluginPath; // first --plugin
+    std::vector<std::string> pluginPaths; // every --plugin, in order (more than one => chain)
+    std::string chainFile; // one plugin path per line, processed as a serial chain
+    double sampleRate = 48000.0; // first --sr entry (the only one outside the matrix)
+    int channels = 2; // channel count of the first --channels entry (resolved in main)
+    std::string bitDepth = "32f"; // 32f, 64f; first --bits entry
+    std::vector<double> sampleRates {48000.0}; // --sr list: matrix axis
+    std::vector<std::string> channelLayouts {"2"}; // --channels list: counts or layout names; matrix axis
+    bool channelSweep = false; // Per-channel cost over the --channels layouts instead of the per-block table
+    bool sidechain = false; // Every matrix cell twice: auxiliary inputs off, then on and fed
+    std::string sidechainStimulus = "transient"; // Signal on the auxiliary inputs
+    std::vector<std::string> bitDepths {"32f"}; // --bits list: matrix axis
     std::vector<int> buffers {32,64,128,256,512,1024,2048,4096,8192,16384};
     int warmup = 40;
     int iterations = 400;
     std::string outCsv; // empty => stdout
     std::string presetJson; // StoryBored JSON preset path
     bool nonRealtime = false; // Use non-realtime processing mode
+    std::string sched = "none"; // none, fifo, deadline
+    int rtPriority = 80; // SCHED_FIFO priority
+    double deadlineRuntimePct = 95.0; // SCHED_DEADLINE runtime share of the period
+    std::string timer = "juce"; // juce, tsc, monotonic-raw
+    bool perfCounters = false; // Read hardware counters around each timed block
+    std::vector<double> budgetFractions {0.5, 0.8}; // extra budget thresholds (fractions of block/sr)
+    std::string paced = "off"; // off, sleep, spin, hybrid
+    bool coldCache = false; // Add a cache-cold pass next to the default one
+    int evictKb = 32768; // Thrash buffer size for --cold-cache
+    bool flushBuffers = false; // Also flush the processing buffer in the cold pass
+    bool rtAudit = false; // Count allocations, locks and syscalls inside processBlock
+    int rtAuditBacktraces = 0; // Backtraces for the first N offending calls
+    std::vector<std::string> stimuli; // Extra passes on built-in test signals
+    bool denormals = false; // Repeat passes with FTZ/DAZ off, plus a decaying tail
+    std::vector<std::string> automate; // Parameters for the automation pass ("all", indices, IDs, names)
+    std::string automationShape = "ramp"; // ramp, step, random
+    int automationEvery = 1; // Move automated parameters every N blocks
+    std::vector<int> midiPolyphony; // One MIDI workload pass per polyphony limit
+    double midiDensity = 0.0; // Note-ons per second; 0 = polyphony / note length
+    double midiNoteLength = 1.0; // Seconds
+    int midiVelocityMin = 100, midiVelocityMax = 100;
+    double midiCcRate = 0.0; // CC events per second (0 = off)
+    int midiCc = 1; // Controller number of the CC stream
+    double midiBendRate = 0.0; // Pitch-bend events per second (0 = off)
+    bool mpe = false; // MPE lower zone: per-note channels and expression
+    std::vector<std::string> inputFiles; // --input-file, repeatable
+    std::vector<std::string> inputDirs; // --input-dir, repeatable (searched recursively)
+    bool osNoise = false; // Page faults / context switches per timed block
+    int osNoiseTop = 5; // Slowest blocks to attribute with --os-noise
+    int lifecycleCycles = 0; // Load/unload cycles instead of the per-block table
+    bool memory = false; // Memory footprint profile instead of the per-block table
+    int memoryInstances = 4; // Memory: extra instances for the per-instance cost
+    int memoryCycles = 10; // Memory: release/prepare and create/destroy leak cycles
+    bool scaling = false; // Multi-instance scaling search instead of the per-block table
+    std::vector<int> scalingThreads; // empty => 1,2,4,... below the physical core count, then the count itself
+    double targetMissRate = 0.001; // Scaling/polyphony: highest acceptable period miss rate
+    int maxInstances = 256; // Scaling: search ceiling
+    bool polyphonySearch = false; // Held-note polyphony search instead of the per-block table
+    int maxVoices = 256; // Polyphony: search ceiling
+    std::string blockStream; // Variable block sizes: random|split|trace (empty = off)
+    int blockMin = 1; // Block stream: smallest random size
+    double splitRate = 200.0; // Block stream: automation points per second (split)
+    std::string blockTrace; // Block stream: recorded host block sizes (trace)
+    bool pinThreads = false; // Scaling/session: pin worker i to logical CPU i
+    int phaseFd = -1; // Phase markers for plugperf-batch's watchdogs (-1 = off)
+    std::string sessionPath; // Session graph JSON (replaces --plugin)
+    std::vector<int> graphThreads; // Session worker-thread counts; empty => physical cores
 };
 
 static inline std::vector<int> parseIntList(const std::string& s) {
@@ -30,6 +85,24 @@ static inline std::vector<int> parseIntList(const std::string& s) {
     return v;
 }
 
+static inline std::vector<double> parseDoubleList(const std::string& s) {
+    std::vector<double> v; v.reserve(8);
+    std::stringstream ss(s); std::string item;
+    while (std::getline(ss, item, ',')) {
+        try { v.push_back(std::stod(item)); } catch (...) {}
+    }
+    return v;
+}
+
+static inline std::vector<std::string> parseStringList(const std::string& s) {
+    std::vector<std::string> v;
+    std::stringstream ss(s); std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) v.push_back(item);
+    }
+    return v;
+}
+
 static inline void printHelp(const char* argv0) {
     std::fprintf(stderr,
 R"HELP(
@@ -37,12 +110,22 @@ Usage: %s --plugin /path/Your.vst3 [options]
 
 Required:
   --plugin PATH            Path to .vst3 bundle to measure
+                           Repeat to benchmark a serial insert chain
+  (or --chain FILE)        Chain file: one plugin path per line, in order
+  (or --session PATH)      Session graph JSON: tracks, buses and master with
+                           their insert plugins (see README)
 
 Options:
   --sr HZ                  Sample rate, e.g. 44100|48000|96000 (default 48000)
-  --channels N             Channel count (default 2)
+  --channels N|LAYOUT      Channel count or layout (default 2): a count (1, 2,
+                           or N discrete channels), lcr, quad, 5.0, 5.1, 6.1,
+                           7.0, 7.1, 5.1.2, 5.1.4, 7.1.2, 7.1.4, 9.1.6, or
+                           ambi1..ambi7 (ambisonic order)
   --bits DEPTH             Bit depth: 32f|64f (default 32f)
                            32f=32-bit float, 64f=64-bit double
+                           --sr, --channels and --bits also take lists
+                           (e.g. --sr 44100,96000 --bits 32f,64f): every
+                           combination runs against the same instance
   --buffers CSV            Buffer sizes list (default 32..16384)
                            e.g. 32,64,128,256,512,1024,2048,4096,8192,16384
   --warmup N               Warmup iterations per size (default 40)
@@ -50,6 +133,108 @@ Options:
   --out PATH               Write CSV to PATH (default stdout)
   --preset-json PATH       Load StoryBored JSON preset before benchmarking
   --non-realtime           Use non-realtime processing mode (default: realtime)
+  --sched POLICY           Measuring thread: none|fifo|deadline (default none)
+                           none=inline on the message thread, fifo=SCHED_FIFO
+                           audio thread, deadline=SCHED_DEADLINE with the
+                           block period as deadline (Linux only)
+  --rt-priority N          SCHED_FIFO priority 1-99 (default 80)
+  --deadline-runtime-pct P SCHED_DEADLINE runtime as %% of the period (default 95)
+  --timer BACKEND          Block timer: juce|tsc|monotonic-raw (default juce)
+                           tsc=serialized rdtsc/rdtscp (needs invariant TSC)
+                           monotonic-raw=clock_gettime(CLOCK_MONOTONIC_RAW)
+  --perf-counters          Record cycles, instructions, IPC, L1D/LLC/dTLB and
+                           branch misses per block via perf_event_open (Linux)
+  --budget-fractions CSV   Count blocks over these fractions of the block/sr
+                           budget, in addition to full misses (default 0.5,0.8)
+  --paced MODE             Emulate a device callback once per block/sr period:
+                           off|sleep|spin|hybrid (default off = back-to-back)
+  --cold-cache             Also run a cache-cold pass that evicts the caches
+                           before every timed block (scenario=cold_cache)
+  --evict-kb N             Cold pass thrash buffer in KiB; should exceed the
+                           last-level cache (default 32768)
+  --flush-buffers          Cold pass also flushes the audio buffer's cache lines
+  --rt-audit               Count heap allocations/frees, mutex/rwlock/condvar
+                           calls and syscalls made inside processBlock
+                           (Linux/glibc; syscalls need perf tracepoint access).
+                           The hooks are linked in and forward every
+                           allocation and lock of the process even without
+                           this flag; they only count while it is set
+  --rt-audit-backtraces N  Print backtraces of the first N offending calls
+                           per buffer size (default 0, max 16)
+  --stimulus CSV           Extra passes on test signals refilled before every
+                           block: silence, white, pink, sweep, impulse, clip,
+                           transient, decay (scenario = signal name)
+  --denormals              Repeat every warm pass with FTZ/DAZ cleared and add
+                           a decaying-tail pass (scenario suffix _no_ftz)
+  --automate CSV           Extra pass that moves these parameters before every
+                           block: all, or indices/IDs/names (scenario = automation)
+  --automation-shape S     ramp (1 s up and down), step (0.25/0.75 jumps) or
+                           random (random walk); default ramp
+  --automation-every N     Move the parameters every N blocks (default 1)
+  --midi-polyphony CSV     One MIDI workload pass per polyphony limit, e.g.
+                           1,8,32 (scenario = midi_p<N>; for instruments)
+  --midi-density N         Note-ons per second (default: polyphony / note
+                           length, which keeps about N notes sounding)
+  --midi-note-length S     Note length in seconds (default 1.0)
+  --midi-velocity V[-V]    Fixed velocity or a random range (default 100)
+  --midi-cc-rate HZ        Add a CC stream at HZ events per second (default 0)
+  --midi-cc N              Controller number of that stream (default 1)
+  --midi-bend-rate HZ      Add a pitch-bend stream (per note with --mpe)
+  --mpe                    MPE lower zone: one member channel per note, with
+                           per-note bend, pressure and CC74
+  --input-file PATH        Extra pass on decoded audio files (repeatable;
+                           scenario = input_file)
+  --input-dir PATH         Add every audio file under PATH to the input files
+  --os-noise               Sample page faults, context switches and run-queue
+                           wait around every timed block (Linux)
+  --os-noise-top N         Print OS activity of the N slowest blocks (default 5)
+  --lifecycle N            Time N full load/unload cycles (scan, instantiate,
+                           layout, preset, prepare, first block, release,
+                           destroy) at the first buffer size (writes the
+                           lifecycle CSV)
+  --memory                 Profile RSS/PSS/USS through loading, prepare, extra
+                           instances and leak cycles (writes the memory CSV;
+                           Linux)
+  --memory-instances K     Memory: extra instances created (default 4)
+  --memory-cycles N        Memory: leak-check cycles of each kind (default 10)
+  --scaling                Find the most instances that meet the deadline for
+                           each worker-thread count (writes the scaling CSV)
+  --scaling-threads CSV    Worker-thread counts (default 1,2,4,.. and the
+                           physical core count itself, at most the CPUs
+                           the process may run on)
+  --polyphony-search       Find the most held notes that meet the deadline
+                           at each buffer size, and the cost per voice
+                           (instruments; writes the polyphony CSV)
+  --max-voices N           Polyphony: voice count search ceiling (default 256)
+  --channel-sweep          Measure every --channels layout (default 1,2,4,6,8,
+                           12,16) at each buffer size and fit the cost per
+                           channel (writes the channel-sweep CSV)
+  --sidechain              Run every cell with the plugin's auxiliary input
+                           buses disabled, then enabled and fed; adds the
+                           sidechain columns and the slowdown of the on run
+  --sidechain-stimulus S   Signal on the auxiliary inputs (a --stimulus
+                           name; default transient)
+  --block-stream PATTERN   Prepare with each buffer size as the maximum, then
+                           call processBlock with varying sizes: random,
+                           split (host periods cut at automation points) or
+                           trace (--block-trace); writes the block-stream CSV
+  --block-min N            Block stream: smallest random size (default 1)
+  --split-rate HZ          Block stream: automation points per second for
+                           split (default 200); --automate moves parameters
+                           at each point
+  --block-trace PATH       Block stream: recorded host block sizes, one per
+                           call (whitespace or comma separated)
+  --target-miss-rate R     Scaling/polyphony: acceptable share of missed
+                           periods (default 0.001)
+  --max-instances N        Scaling: instance count search ceiling (default 256)
+  --pin-threads            Scaling/session: pin worker i to the i-th CPU the
+                           process may run on; thread counts above the
+                           allowed CPU count are rejected
+  --graph-threads CSV      Session: worker-pool sizes to run the graph on
+                           (default: physical core count, at most the CPUs
+                           the process may run on)
+  --phase-fd N             Write phase markers (scan, load, prepare, process)
+                           to descriptor N; used by plugperf-batch
   -h, --help               Show this help and exit
 )HELP", argv0);
 }
@@ -57,30 +242,261 @@ Options:
 static inline bool parseArgs(int argc, char** argv, Args& a) {
     if (argc <= 1) { printHelp(argv[0]); return false; }
 
+    bool channelsGiven = false;
+    bool budgetFractionsGiven = false;
     for (int i = 1; i < argc; ++i) {
         std::string k = argv[i];
         auto need = [&](const char* name){ if (i+1 >= argc) { std::fprintf(stderr, "Missing value for %s\n", name); return false; } return true; };
 
         if (k == "-h" || k == "--help") { printHelp(argv[0]); return false; }
-        else if (k == "--plugin") { if (!need("--plugin")) return false; a.pluginPath = argv[++i]; }
-        else if (k == "--sr") { if (!need("--sr")) return false; a.sampleRate = std::stod(argv[++i]); }
-        else if (k == "--channels") { if (!need("--channels")) return false; a.channels = std::stoi(argv[++i]); }
-        else if (k == "--bits") { if (!need("--bits")) return false; a.bitDepth = argv[++i]; }
+        else if (k == "--plugin") {
+            if (!need("--plugin")) return false;
+            a.pluginPaths.push_back(argv[++i]);
+            if (a.pluginPath.empty()) a.pluginPath = a.pluginPaths.back();
+        }
+        else if (k == "--chain") { if (!need("--chain")) return false; a.chainFile = argv[++i]; }
+        else if (k == "--sr") { if (!need("--sr")) return false; a.sampleRates = parseDoubleList(argv[++i]); }
+        else if (k == "--channels") { if (!need("--channels")) return false; a.channelLayouts = parseStringList(argv[++i]); channelsGiven = true; }
+        else if (k == "--bits") { if (!need("--bits")) return false; a.bitDepths = parseStringList(argv[++i]); }
         else if (k == "--buffers") { if (!need("--buffers")) return false; a.buffers = parseIntList(argv[++i]); }
         else if (k == "--warmup") { if (!need("--warmup")) return false; a.warmup = std::stoi(argv[++i]); }
         else if (k == "--iterations") { if (!need("--iterations")) return false; a.iterations = std::stoi(argv[++i]); }
         else if (k == "--out") { if (!need("--out")) return false; a.outCsv = argv[++i]; }
         else if (k == "--preset-json") { if (!need("--preset-json")) return false; a.presetJson = argv[++i]; }
         else if (k == "--non-realtime") { a.nonRealtime = true; }
+        else if (k == "--sched") { if (!need("--sched")) return false; a.sched = argv[++i]; }
+        else if (k == "--rt-priority") { if (!need("--rt-priority")) return false; a.rtPriority = std::stoi(argv[++i]); }
+        else if (k == "--budget-fractions") { if (!need("--budget-fractions")) return false; a.budgetFractions = parseDoubleList(argv[++i]); budgetFractionsGiven = true; }
+        else if (k == "--paced") { if (!need("--paced")) return false; a.paced = argv[++i]; }
+        else if (k == "--cold-cache") { a.coldCache = true; }
+        else if (k == "--evict-kb") { if (!need("--evict-kb")) return false; a.evictKb = std::stoi(argv[++i]); }
+        else if (k == "--flush-buffers") { a.flushBuffers = true; }
+        else if (k == "--session") { if (!need("--session")) return false; a.sessionPath = argv[++i]; }
+        else if (k == "--graph-threads") { if (!need("--graph-threads")) return false; a.graphThreads = parseIntList(argv[++i]); }
+        else if (k == "--rt-audit") { a.rtAudit = true; }
+        else if (k == "--rt-audit-backtraces") { if (!need("--rt-audit-backtraces")) return false; a.rtAuditBacktraces = std::stoi(argv[++i]); }
+        else if (k == "--stimulus") { if (!need("--stimulus")) return false; a.stimuli = parseStringList(argv[++i]); }
+        else if (k == "--denormals") { a.denormals = true; }
+        else if (k == "--automate") { if (!need("--automate")) return false; a.automate = parseStringList(argv[++i]); }
+        else if (k == "--automation-shape") { if (!need("--automation-shape")) return false; a.automationShape = argv[++i]; }
+        else if (k == "--automation-every") { if (!need("--automation-every")) return false; a.automationEvery = std::stoi(argv[++i]); }
+        else if (k == "--midi-polyphony") { if (!need("--midi-polyphony")) return false; a.midiPolyphony = parseIntList(argv[++i]); }
+        else if (k == "--midi-density") { if (!need("--midi-density")) return false; a.midiDensity = std::stod(argv[++i]); }
+        else if (k == "--midi-note-length") { if (!need("--midi-note-length")) return false; a.midiNoteLength = std::stod(argv[++i]); }
+        else if (k == "--midi-velocity") {
+            if (!need("--midi-velocity")) return false;
+            const std::string v = argv[++i];
+            const size_t dash = v.find('-', 1);
+            a.midiVelocityMin = std::stoi(v.substr(0, dash));
+            a.midiVelocityMax = dash == std::string::npos ? a.midiVelocityMin : std::stoi(v.substr(dash + 1));
+        }
+        else if (k == "--midi-cc-rate") { if (!need("--midi-cc-rate")) return false; a.midiCcRate = std::stod(argv[++i]); }
+        else if (k == "--midi-cc") { if (!need("--midi-cc")) return false; a.midiCc = std::stoi(argv[++i]); }
+        else if (k == "--midi-bend-rate") { if (!need("--midi-bend-rate")) return false; a.midiBendRate = std::stod(argv[++i]); }
+        else if (k == "--mpe") { a.mpe = true; }
+        else if (k == "--input-file") { if (!need("--input-file")) return false; a.inputFiles.push_back(argv[++i]); }
+        else if (k == "--input-dir") { if (!need("--input-dir")) return false; a.inputDirs.push_back(argv[++i]); }
+        else if (k == "--os-noise") { a.osNoise = true; }
+        else if (k == "--os-noise-top") { if (!need("--os-noise-top")) return false; a.osNoiseTop = std::stoi(argv[++i]); }
+        else if (k == "--lifecycle") { if (!need("--lifecycle")) return false; a.lifecycleCycles = std::stoi(argv[++i]); }
+        else if (k == "--memory") { a.memory = true; }
+        else if (k == "--memory-instances") { if (!need("--memory-instances")) return false; a.memoryInstances = std::stoi(argv[++i]); }
+        else if (k == "--memory-cycles") { if (!need("--memory-cycles")) return false; a.memoryCycles = std::stoi(argv[++i]); }
+        else if (k == "--scaling") { a.scaling = true; }
+        else if (k == "--scaling-threads") { if (!need("--scaling-threads")) return false; a.scalingThreads = parseIntList(argv[++i]); }
+        else if (k == "--target-miss-rate") { if (!need("--target-miss-rate")) return false; a.targetMissRate = std::stod(argv[++i]); }
+        else if (k == "--max-instances") { if (!need("--max-instances")) return false; a.maxInstances = std::stoi(argv[++i]); }
+        else if (k == "--polyphony-search") { a.polyphonySearch = true; }
+        else if (k == "--max-voices") { if (!need("--max-voices")) return false; a.maxVoices = std::stoi(argv[++i]); }
+        else if (k == "--block-stream") { if (!need("--block-stream")) return false; a.blockStream = argv[++i]; }
+        else if (k == "--block-min") { if (!need("--block-min")) return false; a.blockMin = std::stoi(argv[++i]); }
+        else if (k == "--split-rate") { if (!need("--split-rate")) return false; a.splitRate = std::stod(argv[++i]); }
+        else if (k == "--block-trace") { if (!need("--block-trace")) return false; a.blockTrace = argv[++i]; }
+        else if (k == "--channel-sweep") { a.channelSweep = true; }
+        else if (k == "--sidechain") { a.sidechain = true; }
+        else if (k == "--sidechain-stimulus") { if (!need("--sidechain-stimulus")) return false; a.sidechainStimulus = argv[++i]; }
+        else if (k == "--pin-threads") { a.pinThreads = true; }
+        else if (k == "--phase-fd") { if (!need("--phase-fd")) return false; a.phaseFd = std::stoi(argv[++i]); }
+        else if (k == "--perf-counters") { a.perfCounters = true; }
+        else if (k == "--timer") { if (!need("--timer")) return false; a.timer = argv[++i]; }
+        else if (k == "--deadline-runtime-pct") { if (!need("--deadline-runtime-pct")) return false; a.deadlineRuntimePct = std::stod(argv[++i]); }
         else { std::fprintf(stderr, "Unknown option: %s\n", k.c_str()); return false; }
     }
 
-    if (a.pluginPath.empty()) { std::fprintf(stderr, "--plugin is required\n"); return false; }
-    if (a.channels <= 0) { std::fprintf(stderr, "--channels must be > 0\n"); return false; }
-    if (a.sampleRate <= 0) { std::fprintf(stderr, "--sr must be > 0\n"); return false; }
+    const bool chain = a.pluginPaths.size() > 1 || !a.chainFile.empty();
+    // Instrumentation of the single-plugin timed loop; other modes have no such loop
+    const bool perBlockFlags = a.coldCache || a.perfCounters || a.rtAudit || a.osNoise || budgetFractionsGiven;
+    if (a.pluginPath.empty() && a.chainFile.empty() && a.sessionPath.empty()) {
+        std::fprintf(stderr, "--plugin, --chain or --session is required\n"); return false;
+    }
+    if ((!a.pluginPath.empty() || !a.chainFile.empty()) && !a.sessionPath.empty()) {
+        std::fprintf(stderr, "--session cannot be combined with --plugin or --chain\n"); return false;
+    }
+    if (!a.sessionPath.empty() && perBlockFlags) {
+        std::fprintf(stderr, "--cold-cache, --perf-counters, --rt-audit, --os-noise and --budget-fractions "
+                             "are not supported with --session\n"); return false;
+    }
+    if (chain && (a.paced != "off" || a.coldCache || a.perfCounters || a.rtAudit || a.osNoise || budgetFractionsGiven)) {
+        std::fprintf(stderr, "--paced, --cold-cache, --perf-counters, --rt-audit, --os-noise and --budget-fractions "
+                             "are not supported in chain mode\n"); return false;
+    }
+    if (a.scaling && (chain || !a.sessionPath.empty())) {
+        std::fprintf(stderr, "--scaling needs a single --plugin\n"); return false;
+    }
+    if (a.scaling && perBlockFlags) {
+        std::fprintf(stderr, "--cold-cache, --perf-counters, --rt-audit, --os-noise and --budget-fractions "
+                             "are not supported with --scaling\n"); return false;
+    }
+    if (a.lifecycleCycles < 0) { std::fprintf(stderr, "--lifecycle must be >= 0\n"); return false; }
+    if (a.lifecycleCycles > 0 && (chain || !a.sessionPath.empty() || a.scaling)) {
+        std::fprintf(stderr, "--lifecycle needs a single --plugin and cannot be combined with --scaling\n"); return false;
+    }
+    if (a.lifecycleCycles > 0 && (a.paced != "off" || a.sched != "none" || perBlockFlags)) {
+        std::fprintf(stderr, "--paced, --sched, --cold-cache, --perf-counters, --rt-audit, --os-noise and --budget-fractions "
+                             "are not supported with --lifecycle\n"); return false;
+    }
+    if (a.memory && (chain || !a.sessionPath.empty() || a.scaling || a.lifecycleCycles > 0)) {
+        std::fprintf(stderr, "--memory needs a single --plugin and cannot be combined with --scaling or --lifecycle\n"); return false;
+    }
+    if (a.memory && (a.paced != "off" || a.sched != "none" || perBlockFlags)) {
+        std::fprintf(stderr, "--paced, --sched, --cold-cache, --perf-counters, --rt-audit, --os-noise and --budget-fractions "
+                             "are not supported with --memory\n"); return false;
+    }
+    if (a.polyphonySearch && (chain || !a.sessionPath.empty() || a.scaling || a.lifecycleCycles > 0 || a.memory)) {
+        std::fprintf(stderr, "--polyphony-search needs a single --plugin and cannot be combined with --scaling, --lifecycle or --memory\n"); return false;
+    }
+    if (a.polyphonySearch && perBlockFlags) {
+        std::fprintf(stderr, "--cold-cache, --perf-counters, --rt-audit, --os-noise and --budget-fractions "
+                             "are not supported with --polyphony-search\n"); return false;
+    }
+    const bool blockStream = !a.blockStream.empty();
+    if (blockStream && a.blockStream != "random" && a.blockStream != "split" && a.blockStream != "trace") {
+        std::fprintf(stderr, "--block-stream must be one of: random, split, trace\n"); return false;
+    }
+    if (blockStream && (chain || !a.sessionPath.empty() || a.scaling || a.lifecycleCycles > 0 || a.memory || a.polyphonySearch)) {
+        std::fprintf(stderr, "--block-stream needs a single --plugin and cannot be combined with another search or profile mode\n"); return false;
+    }
+    if (blockStream && (a.paced != "off" || perBlockFlags)) {
+        std::fprintf(stderr, "--paced, --cold-cache, --perf-counters, --rt-audit, --os-noise and --budget-fractions "
+                             "are not supported with --block-stream\n"); return false;
+    }
+    if ((a.blockStream == "trace") != !a.blockTrace.empty()) {
+        std::fprintf(stderr, "--block-trace goes together with --block-stream trace\n"); return false;
+    }
+    if (a.blockMin < 1) { std::fprintf(stderr, "--block-min must be >= 1\n"); return false; }
+    if (a.splitRate < 0) { std::fprintf(stderr, "--split-rate must be >= 0\n"); return false; }
+    if (a.maxVoices <= 0) { std::fprintf(stderr, "--max-voices must be > 0\n"); return false; }
+    if (a.memoryInstances < 0 || a.memoryCycles < 0) {
+        std::fprintf(stderr, "--memory-instances and --memory-cycles must be >= 0\n"); return false;
+    }
+    if (a.channelSweep && !channelsGiven)
+        a.channelLayouts = { "1", "2", "4", "6", "8", "12", "16" };
+    if (a.sampleRates.empty() || a.channelLayouts.empty() || a.bitDepths.empty()) {
+        std::fprintf(stderr, "--sr, --channels and --bits need at least one value\n"); return false;
+    }
+    for (double r : a.sampleRates) {
+        if (r <= 0) { std::fprintf(stderr, "--sr must be > 0\n"); return false; }
+    }
     if (a.buffers.empty()) { std::fprintf(stderr, "--buffers resulted in empty list\n"); return false; }
-    if (a.bitDepth != "32f" && a.bitDepth != "64f") {
-        std::fprintf(stderr, "--bits must be one of: 32f, 64f\n"); return false;
+    for (const auto& b : a.bitDepths) {
+        if (b != "32f" && b != "64f") { std::fprintf(stderr, "--bits must be one of: 32f, 64f\n"); return false; }
+    }
+    a.sampleRate = a.sampleRates.front();
+    a.bitDepth = a.bitDepths.front();
+    const bool matrix = a.sampleRates.size() > 1 || a.channelLayouts.size() > 1 || a.bitDepths.size() > 1;
+    if (matrix && (chain || !a.sessionPath.empty() || a.scaling || a.lifecycleCycles > 0 || a.memory
+                   || a.polyphonySearch || !a.blockStream.empty())) {
+        std::fprintf(stderr, "Lists for --sr, --channels and --bits apply to the single-plugin benchmark only\n"); return false;
+    }
+    if (a.channelSweep && (chain || !a.sessionPath.empty() || a.scaling || a.lifecycleCycles > 0 || a.memory
+                           || a.polyphonySearch || !a.blockStream.empty()
+                           || a.sampleRates.size() > 1 || a.bitDepths.size() > 1)) {
+        std::fprintf(stderr, "--channel-sweep needs a single --plugin, one --sr and one --bits, and no other search or profile mode\n"); return false;
+    }
+    if (a.channelSweep && (a.coldCache || a.perfCounters || a.rtAudit || a.osNoise || budgetFractionsGiven)) {
+        std::fprintf(stderr, "--channel-sweep runs the default pass only; --cold-cache, --perf-counters, --rt-audit, "
+                             "--os-noise and --budget-fractions are not supported with it\n"); return false;
+    }
+    if (a.sidechain && (chain || !a.sessionPath.empty() || a.scaling || a.lifecycleCycles > 0 || a.memory
+                        || a.polyphonySearch || !a.blockStream.empty() || a.channelSweep)) {
+        std::fprintf(stderr, "--sidechain applies to the single-plugin benchmark only\n"); return false;
+    }
+    if (a.sidechainStimulus != "silence" && a.sidechainStimulus != "white" && a.sidechainStimulus != "pink"
+        && a.sidechainStimulus != "sweep" && a.sidechainStimulus != "impulse" && a.sidechainStimulus != "clip"
+        && a.sidechainStimulus != "transient" && a.sidechainStimulus != "decay") {
+        std::fprintf(stderr, "--sidechain-stimulus must be silence, white, pink, sweep, impulse, clip, transient or decay\n");
+        return false;
+    }
+    if (a.sched != "none" && a.sched != "fifo" && a.sched != "deadline") {
+        std::fprintf(stderr, "--sched must be one of: none, fifo, deadline\n"); return false;
+    }
+    if (a.timer != "juce" && a.timer != "tsc" && a.timer != "monotonic-raw") {
+        std::fprintf(stderr, "--timer must be one of: juce, tsc, monotonic-raw\n"); return false;
+    }
+    if (a.paced != "off" && a.paced != "sleep" && a.paced != "spin" && a.paced != "hybrid") {
+        std::fprintf(stderr, "--paced must be one of: off, sleep, spin, hybrid\n"); return false;
+    }
+    for (double f : a.budgetFractions) {
+        if (f <= 0) { std::fprintf(stderr, "--budget-fractions entries must be > 0\n"); return false; }
+    }
+    if (a.evictKb <= 0) { std::fprintf(stderr, "--evict-kb must be > 0\n"); return false; }
+    if (a.flushBuffers && !a.coldCache) {
+        std::fprintf(stderr, "--flush-buffers requires --cold-cache\n"); return false;
+    }
+    if (a.rtAuditBacktraces < 0 || a.rtAuditBacktraces > 16) {
+        std::fprintf(stderr, "--rt-audit-backtraces must be 0-16\n"); return false;
+    }
+    if (a.rtAuditBacktraces > 0 && !a.rtAudit) {
+        std::fprintf(stderr, "--rt-audit-backtraces requires --rt-audit\n"); return false;
+    }
+    if ((!a.inputFiles.empty() || !a.inputDirs.empty() || !a.stimuli.empty() || a.denormals || !a.automate.empty()
+         || !a.midiPolyphony.empty())
+        && (chain || !a.sessionPath.empty() || a.scaling || a.lifecycleCycles > 0 || a.memory || a.polyphonySearch
+            || a.channelSweep)) {
+        std::fprintf(stderr, "--stimulus, --denormals, --automate, --midi-polyphony and --input-file/--input-dir apply to the single-plugin benchmark only\n"); return false;
+    }
+    if (blockStream && (!a.inputFiles.empty() || !a.inputDirs.empty() || !a.stimuli.empty() || a.denormals
+                        || !a.midiPolyphony.empty() || (!a.automate.empty() && a.blockStream != "split"))) {
+        std::fprintf(stderr, "--block-stream only combines with --automate, and only for split\n"); return false;
+    }
+    if (a.automationShape != "ramp" && a.automationShape != "step" && a.automationShape != "random") {
+        std::fprintf(stderr, "--automation-shape must be one of: ramp, step, random\n"); return false;
+    }
+    for (int p : a.midiPolyphony) {
+        if (p <= 0) { std::fprintf(stderr, "--midi-polyphony entries must be > 0\n"); return false; }
+    }
+    if (a.midiDensity < 0 || a.midiNoteLength <= 0) {
+        std::fprintf(stderr, "--midi-density must be >= 0 and --midi-note-length > 0\n"); return false;
+    }
+    if (a.midiVelocityMin < 1 || a.midiVelocityMax > 127 || a.midiVelocityMin > a.midiVelocityMax) {
+        std::fprintf(stderr, "--midi-velocity must be 1-127 (MIN-MAX with MIN <= MAX)\n"); return false;
+    }
+    if (a.midiCc < 0 || a.midiCc > 127) { std::fprintf(stderr, "--midi-cc must be 0-127\n"); return false; }
+    if (a.midiCcRate < 0 || a.midiBendRate < 0) {
+        std::fprintf(stderr, "--midi-cc-rate and --midi-bend-rate must be >= 0\n"); return false;
+    }
+    if (a.automationEvery < 1) { std::fprintf(stderr, "--automation-every must be >= 1\n"); return false; }
+    for (const auto& st : a.stimuli) {
+        if (st != "silence" && st != "white" && st != "pink" && st != "sweep" && st != "impulse"
+            && st != "clip" && st != "transient" && st != "decay") {
+            std::fprintf(stderr, "--stimulus entries must be silence, white, pink, sweep, impulse, clip, transient or decay\n");
+            return false;
+        }
+    }
+    if (a.osNoiseTop < 0) { std::fprintf(stderr, "--os-noise-top must be >= 0\n"); return false; }
+    for (int t : a.graphThreads) {
+        if (t <= 0) { std::fprintf(stderr, "--graph-threads entries must be > 0\n"); return false; }
+    }
+    for (int t : a.scalingThreads) {
+        if (t <= 0) { std::fprintf(stderr, "--scaling-threads entries must be > 0\n"); return false; }
+    }
+    if (a.targetMissRate < 0 || a.targetMissRate >= 1) {
+        std::fprintf(stderr, "--target-miss-rate must be in [0, 1)\n"); return false;
+    }
+    if (a.maxInstances <= 0) { std::fprintf(stderr, "--max-instances must be > 0\n"); return false; }
+    if (a.rtPriority < 1 || a.rtPriority > 99) { std::fprintf(stderr, "--rt-priority must be 1-99\n"); return false; }
+    if (a.deadlineRuntimePct <= 0 || a.deadlineRuntimePct > 100) {
+        std::fprintf(stderr, "--deadline-runtime-pct must be in (0, 100]\n"); return false;
     }
 
     return true;
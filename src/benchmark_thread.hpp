@@ -6,12 +6,61 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <array>
+#include <memory>
+#include <string>
+
+#include "rt_scheduling.hpp"
+#include "block_timer.hpp"
+#include "perf_counters.hpp"
+#include "latency_histogram.hpp"
+#include "period_pacer.hpp"
+#include "cache_evictor.hpp"
+#include "rt_audit.hpp"
+#include "os_noise.hpp"
+#include "lifecycle.hpp"
+#include "signal_generator.hpp"
+#include "param_automation.hpp"
+#include "midi_workload.hpp"
+#include "phase_report.hpp"
 
 using namespace juce;
 
 struct Stats {
     double mean, median, p95, min, max, stdDev, cv, rtPct, dspLoad;
+    double p90, p99, p999, p9999;
     int latency;
+
+    // Real-time budget (block / sr) accounting
+    double maxOverBudget;          // us by which the slowest block overran the budget (0 if none)
+    uint64 deadlineMisses;         // blocks slower than the full budget
+    double deadlineMissRate;
+    std::vector<uint64> overBudgetFraction; // per BenchmarkConfig::budgetFractions entry
+    std::vector<double> overBudgetFractionRate;
+
+    // Paced mode (--paced): wake-up lateness against each period deadline
+    bool paced;
+    double wakeJitterMean, wakeJitterP99, wakeJitterMax; // us
+    uint64 xruns;
+
+    // Hardware counters, mean per processBlock (--perf-counters)
+    bool hwCounters;
+    double hwCycles, hwInstructions, ipc, l1dMisses, llcMisses, branchMisses, dtlbMisses;
+    std::array<bool, PerfCounterGroup::NumCounters> hwAvailable;
+
+    // Real-time safety audit, totals over the timed blocks (--rt-audit)
+    bool rtAudit;
+    uint64 rtAllocs, rtFrees, rtAllocBytes, rtLockOps, rtCondOps;
+    int64 rtSyscalls;                // -1 when the syscall counter was unavailable
+    uint64 rtUnsafeBlocks;           // blocks with at least one audited call
+
+    // OS noise over the timed blocks (--os-noise): faults, switches, run-queue wait
+    bool osNoise;
+    int64 osMinorFaults, osMajorFaults, osVoluntarySwitches, osInvoluntarySwitches;
+    double osRunQueueWait;           // us
+    uint64 osNoisyBlocks;            // blocks with any fault or context switch
+    double osNoisyMean;              // us, mean of those blocks
+    double osQuietMean, osQuietP99;  // us, blocks without OS events: the plugin's own cost
 };
 
 struct BenchmarkConfig {
@@ -23,18 +72,65 @@ struct BenchmarkConfig {
     int timedIterations = 0;
     bool useDoublePrecision = false;
     bool nonRealtime = false;
+    SchedPolicy schedPolicy = SchedPolicy::None;
+    int rtPriority = 80;             // SCHED_FIFO priority (1-99)
+    double deadlineRuntimePct = 95.0; // SCHED_DEADLINE runtime as % of the block period
+    TimerBackend timer = TimerBackend::Juce;
+    bool perfCounters = false;
+    std::vector<double> budgetFractions; // extra thresholds as fractions of block / sr
+    PacingMode pacing = PacingMode::None; // wait for each period deadline between blocks
+    bool coldCache = false;          // add a pass that evicts caches before every timed block
+    size_t evictBytes = 32u << 20;   // thrash buffer size for the cold pass
+    bool flushIoBuffers = false;     // also clflush the processing buffer in the cold pass
+    bool rtAudit = false;            // count allocations, locks and syscalls inside processBlock
+    int rtAuditBacktraces = 0;       // keep backtraces for the first N offending calls
+    bool osNoise = false;            // sample faults/switches around every timed block
+    int osNoiseTop = 5;              // report OS activity of the N slowest blocks
+    std::vector<Stimulus> stimuli;   // one extra pass per test signal, refilled every block
+    InputSource* fileInput = nullptr; // decoded program material (scenario "input_file"), owned by the caller
+    bool denormals = false;          // repeat the passes with FTZ/DAZ cleared, plus a decaying tail
+    std::vector<std::string> automate; // parameters to automate in an extra pass ("all", indices, IDs, names)
+    AutomationShape automationShape = AutomationShape::Ramp;
+    int automationEvery = 1;         // move the parameters every N blocks
+    std::vector<int> midiPolyphony;  // one MIDI workload pass per polyphony limit
+    MidiWorkloadConfig midi;         // note density, velocity, CC/bend streams, MPE
+    InputSource* sidechain = nullptr; // key signal for the auxiliary inputs, owned by the caller
+    int sidechainOffset = 0;         // first buffer channel of the auxiliary inputs
+    int sidechainChannels = 0;       // channels on enabled auxiliary inputs (0 = none)
 };
 
-struct BenchmarkResult {
+/**
+ * One timed pass over the same prepared plugin. The first scenario of a
+ * result is the default pass; the others vary one condition against it.
+ */
+struct ScenarioStats {
+    std::string name;
     Stats stats;
+    std::string ftzReference; // for passes without FTZ/DAZ: the same pass with the flags set
+    int midiPolyphony = 0;        // MIDI workload passes: the polyphony limit
+    double midiEventsPerBlock = 0.0;
+    int midiPeakVoices = 0;       // ... and the notes actually sounding
+    double midiMeanVoices = 0.0;
+};
+
+struct BenchmarkResult {
+    std::vector<ScenarioStats> scenarios;
     bool success = false;
     String errorMessage;
+    std::string schedPolicy; // policy actually granted to the measuring thread
+    double prepareMs = -1.0;     // prepareToPlay at this block size
+    double firstBlockUs = -1.0;  // first processBlock after it (-1 without warmup)
 };
 
 /**
- * Dedicated real-time thread for running plugin benchmarks.
- * This matches DAW behavior by running measurements on a high-priority
- * audio thread with time-constraint scheduling (macOS/iOS) or equivalent.
+ * Thread for running plugin benchmarks.
+ * With SchedPolicy::None the measurement runs inline on the calling (message)
+ * thread. Otherwise a real audio-style thread is started with JUCE's realtime
+ * options and then switched to SCHED_FIFO or SCHED_DEADLINE once
+ * prepareToPlay() has returned, while the calling thread keeps dispatching
+ * messages so plugin callbacks still get serviced. Under SCHED_DEADLINE
+ * without pacing every timed block starts a new period (endDeadlineJob), so
+ * one reservation covers one block.
  */
 class BenchmarkThread : public Thread
 {
@@ -62,10 +158,32 @@ public:
             return result_;
         }
 
-        // Run benchmark directly on current thread (message thread) instead of spawning
-        // a separate thread. This avoids MessageManager threading issues in headless environments
-        // where plugins may try to dispatch messages during prepareToPlay()
-        run();
+        if (config_.schedPolicy == SchedPolicy::None)
+        {
+            // Run benchmark directly on current thread (message thread) instead of spawning
+            // a separate thread. This avoids MessageManager threading issues in headless environments
+            // where plugins may try to dispatch messages during prepareToPlay()
+            run();
+            return result_;
+        }
+
+        if (! startRealtimeThread(createRealtimeOptions(config_)))
+        {
+            std::cerr << "WARNING: Could not start realtime thread; "
+                      << "starting a normal thread and requesting the policy from inside it.\n";
+
+            if (! startThread(Priority::highest))
+            {
+                result_.success = false;
+                result_.errorMessage = "Failed to start benchmark thread";
+                return result_;
+            }
+        }
+
+        // Keep the message loop alive while the audio thread measures, so
+        // anything the plugin posts to the message thread gets dispatched
+        while (isThreadRunning())
+            MessageManager::getInstance()->runDispatchLoopUntil(10);
         
         return result_;
     }
@@ -78,9 +196,9 @@ private:
         try
         {
             if (configCopy.useDoublePrecision)
-                result_.stats = measureOneImpl<double>(configCopy);
+                result_.scenarios = measureOneImpl<double>(configCopy);
             else
-                result_.stats = measureOneImpl<float>(configCopy);
+                result_.scenarios = measureOneImpl<float>(configCopy);
 
             result_.success = true;
         }
@@ -98,8 +216,33 @@ private:
         }
     }
     
+    /** What a timed pass changes relative to the default pass. */
+    struct PassSpec {
+        PassSpec(std::string n, bool evict = false, InputSource* in = nullptr)
+            : name(std::move(n)), evictCaches(evict), input(in) {}
+
+        std::string name;
+        bool evictCaches = false;
+        InputSource* input = nullptr; // refill the buffer before every block
+        bool allowDenormals = false;  // clear FTZ/DAZ, as a host without ScopedNoDenormals would
+        ParameterAutomation* automation = nullptr; // move parameters before every block
+        MidiWorkload* midiWorkload = nullptr;      // pre-rendered MIDI per block; the audio buffer starts silent
+        std::string ftzReference;     // the pass this one repeats with FTZ/DAZ set
+    };
+
+    /** Clears FTZ/DAZ for its lifetime, undoing the ScopedNoDenormals of measureOneImpl. */
+    struct ScopedDenormalsAllowed {
+        ScopedDenormalsAllowed() : saved(FloatVectorOperations::getFpStatusRegister())
+        {
+            FloatVectorOperations::disableDenormalisedNumberSupport(false);
+        }
+        ~ScopedDenormalsAllowed() { FloatVectorOperations::setFpStatusRegister(saved); }
+
+        const intptr_t saved;
+    };
+
     template <typename Sample>
-    Stats measureOneImpl(const BenchmarkConfig& cfg)
+    std::vector<ScenarioStats> measureOneImpl(const BenchmarkConfig& cfg)
     {
         ScopedNoDenormals noDenormals;
         
@@ -108,7 +251,6 @@ private:
         const int channels = cfg.channels;
         const double sr = cfg.sampleRate;
         const int warmup = cfg.warmupIterations;
-        const int iters = cfg.timedIterations;
         
         // Recreate processing state per block size to surface reallocations
         std::cerr << "[DEBUG] Calling releaseResources()..." << std::endl;
@@ -116,9 +258,18 @@ private:
         std::cerr << "[DEBUG] Calling setNonRealtime(" << cfg.nonRealtime << ")..." << std::endl;
         plug.setNonRealtime(cfg.nonRealtime); // Use configured processing mode
         std::cerr << "[DEBUG] Calling prepareToPlay(" << sr << ", " << block << ")..." << std::endl;
+        PhaseTimer phase;
+        PhaseReport::enter("prepare");
         plug.prepareToPlay(sr, block);
+        result_.prepareMs = phase.lapMs();
+        PhaseReport::enter("process");
         std::cerr << "[DEBUG] prepareToPlay() completed!" << std::endl;
         
+        // A deadline reservation sized for one block must not cover prepareToPlay
+        applySchedPolicy(cfg);
+        result_.schedPolicy = RealtimeScheduling::describeCurrentThread();
+        const bool jobPerBlock = cfg.schedPolicy == SchedPolicy::Deadline && cfg.pacing == PacingMode::None;
+
         AudioBuffer<Sample> buf(channels, block);
         MidiBuffer midi;
         
@@ -128,62 +279,343 @@ private:
             for (int n = 0; n < block; ++n)
                 buf.setSample(c, n, (Sample)((rng.nextFloat() * 2.0f - 1.0f) * 0.1f));
         
-        // Warmup iterations
-        for (int i = 0; i < warmup; ++i)
+        // Warmup iterations; the first one is the cold first block after prepareToPlay
+        result_.firstBlockUs = -1.0;
+        if (warmup > 0)
+        {
+            if (jobPerBlock)
+                RealtimeScheduling::endDeadlineJob();
+            phase.lapMs();
+            plug.processBlock(buf, midi);
+            result_.firstBlockUs = phase.lapMs() * 1000.0;
+        }
+
+        for (int i = 1; i < warmup; ++i)
         {
             midi.clear();
             plug.processBlock(buf, midi);
         }
         
-        std::vector<double> us;
-        us.reserve((size_t)iters);
-        const double tps = (double) Time::getHighResolutionTicksPerSecond();
+        std::vector<PassSpec> passes { { "default" } };
+        if (cfg.coldCache)
+            passes.push_back({ "cold_cache", true });
+
+        std::vector<std::unique_ptr<InputSource>> sources;
+        for (Stimulus st : cfg.stimuli)
+        {
+            sources.push_back(std::make_unique<SignalGenerator>(st, sr, channels));
+            passes.push_back({ SignalGenerator::name(st), false, sources.back().get() });
+        }
+        if (cfg.fileInput != nullptr)
+            passes.push_back({ "input_file", false, cfg.fileInput });
+
+        // Automation: the default pass again with parameters moving, one curve per second
+        std::unique_ptr<ParameterAutomation> automation;
+        if (! cfg.automate.empty())
+        {
+            automation = std::make_unique<ParameterAutomation>(plug, cfg.automate, cfg.automationShape,
+                                                               cfg.automationEvery,
+                                                               jmax(2, (int) (sr / block)));
+            if (automation->empty())
+            {
+                std::cerr << "WARNING [buffer=" << block << "]: No parameters matched --automate; "
+                          << "skipping the automation pass\n";
+            }
+            else
+            {
+                std::cerr << "Automating " << automation->size() << " parameter(s): "
+                          << automation->describe() << "\n";
+                PassSpec automated("automation");
+                automated.automation = automation.get();
+                passes.push_back(automated);
+            }
+        }
+
+        // Instruments: one pass per polyphony limit, so cost can be read against voice count
+        std::vector<std::unique_ptr<MidiWorkload>> workloads;
+        for (int voices : cfg.midiPolyphony)
+        {
+            MidiWorkloadConfig mc = cfg.midi;
+            mc.polyphony = voices;
+            workloads.push_back(std::make_unique<MidiWorkload>(mc, sr, block));
+            PassSpec withMidi("midi_p" + std::to_string(voices));
+            withMidi.midiWorkload = workloads.back().get();
+            passes.push_back(withMidi);
+        }
+
+        // Denormal sensitivity: every warm pass again without FTZ/DAZ, and a
+        // decaying tail so there is something to flush even if no other
+        // stimulus reaches the denormal range
+        if (cfg.denormals)
+        {
+            if (std::find(cfg.stimuli.begin(), cfg.stimuli.end(), Stimulus::Decay) == cfg.stimuli.end())
+            {
+                auto decay = std::make_unique<SignalGenerator>(Stimulus::Decay, sr, channels);
+                if (decay->subnormalSamples() == 0)
+                    std::cerr << "WARNING: decay stimulus holds no subnormal samples; the _no_ftz passes "
+                              << "only see a burst and silence\n";
+                sources.push_back(std::move(decay));
+                passes.push_back({ "decay", false, sources.back().get() });
+            }
+
+            const size_t withFtz = passes.size();
+            for (size_t p = 0; p < withFtz; ++p)
+            {
+                if (passes[p].evictCaches || passes[p].automation != nullptr || passes[p].midiWorkload != nullptr)
+                    continue;
+                PassSpec twin = passes[p];
+                twin.name += "_no_ftz";
+                twin.allowDenormals = true;
+                twin.ftzReference = passes[p].name;
+                passes.push_back(twin);
+            }
+        }
+
+        std::vector<ScenarioStats> results;
+        for (const auto& pass : passes)
+        {
+            results.push_back({ pass.name, timedPass(cfg, pass, buf, midi), pass.ftzReference });
+            if (pass.automation != nullptr)
+                pass.automation->restore();
+            if (pass.midiWorkload != nullptr)
+            {
+                // Silence the voices so the next pass starts from an idle instrument
+                results.back().midiPolyphony = pass.midiWorkload->polyphony();
+                results.back().midiEventsPerBlock = pass.midiWorkload->eventsPerBlock();
+                results.back().midiPeakVoices = pass.midiWorkload->peakVoices();
+                results.back().midiMeanVoices = pass.midiWorkload->meanVoices();
+                midi.clear();
+                pass.midiWorkload->allNotesOff(midi);
+                buf.clear();
+                plug.processBlock(buf, midi);
+                midi.clear();
+            }
+        }
+
+        plug.releaseResources();
+
+        return results;
+    }
+
+    /**
+     * Run cfg.timedIterations timed blocks on an already prepared and warmed-up
+     * plugin and reduce them to Stats.
+     */
+    template <typename Sample>
+    Stats timedPass(const BenchmarkConfig& cfg, const PassSpec& pass,
+                    AudioBuffer<Sample>& buf, MidiBuffer& midi)
+    {
+        auto& plug = *cfg.plugin;
+        const int block = cfg.blockSize;
+        const double sr = cfg.sampleRate;
+        const int iters = cfg.timedIterations;
+        const String tag = "[buffer=" + String(block)
+                         + (pass.name == "default" ? String() : String(", ") + String(pass.name)) + "]";
+
+        // Fixed-size histogram of raw ticks: memory does not grow with iterations
+        LatencyHistogram hist;
+        const BlockTimer timer(cfg.timer);
         
-        // Timed iterations
+        // Optional hardware counters, opened on the measuring thread
+        PerfCounterGroup counters;
+        if (cfg.perfCounters)
+        {
+            String counterError;
+            if (! counters.open(counterError))
+                std::cerr << "WARNING " << tag << ": Hardware counters unavailable - "
+                          << counterError << "\n";
+        }
+
+        PerfCounterGroup::Snapshot before {}, after {}, totals {};
+
+        // Budget thresholds in ticks, so the loop only compares integers
+        const double usPerTick = timer.ticksToMicros(1);
+        const double rtWindow_us = (double)block * 1e6 / sr;
+        const int64 budgetTicks = (int64) (rtWindow_us / usPerTick);
+        std::vector<int64> fractionTicks;
+        for (double f : cfg.budgetFractions)
+            fractionTicks.push_back((int64) (f * rtWindow_us / usPerTick));
+        std::vector<uint64> overFraction(fractionTicks.size(), 0);
+        uint64 misses = 0;
+
+        // RT-safety audit: hooks only count between begin() and end() on this thread
+        RtAudit::Counts auditTotals;
+        uint64 unsafeBlocks = 0;
+        int tracedBlocks = 0;  // blocks that took a backtrace inside the timed region
+        bool syscallCounter = false;
+        if (cfg.rtAudit)
+        {
+            auditTotals.syscalls = 0;
+            String auditError;
+            syscallCounter = RtAudit::openSyscallCounter(auditError);
+            if (! syscallCounter)
+                std::cerr << "WARNING " << tag << ": Syscall counting unavailable - " << auditError << "\n";
+            RtAudit::setBacktraceLimit(cfg.rtAuditBacktraces);
+        }
+
+        // OS noise: getrusage/schedstat deltas around every timed block
+        OsNoiseProbe osProbe;
+        if (cfg.osNoise)
+        {
+            String osError;
+            if (! osProbe.open(osError))
+                std::cerr << "WARNING " << tag << ": OS noise accounting unavailable - " << osError << "\n";
+        }
+        OsNoiseProbe::Sample osBefore, osTotals;
+        OutlierLog outliers(osProbe.isOpen() ? cfg.osNoiseTop : 0);
+        LatencyHistogram quietHist;
+        uint64 noisyBlocks = 0;
+        int64 noisyTicks = 0;
+
+        std::unique_ptr<ScopedDenormalsAllowed> denormalsAllowed;
+        if (pass.allowDenormals)
+            denormalsAllowed = std::make_unique<ScopedDenormalsAllowed>();
+
+        // Sidechain: the auxiliary input channels get their own key signal,
+        // refilled after the main input (and after a MIDI pass clears the buffer)
+        const bool keyed = cfg.sidechain != nullptr && cfg.sidechainChannels > 0
+                           && cfg.sidechainOffset + cfg.sidechainChannels <= buf.getNumChannels();
+        AudioBuffer<Sample> sidechainView(buf.getArrayOfWritePointers() + (keyed ? cfg.sidechainOffset : 0),
+                                          keyed ? cfg.sidechainChannels : 0, block);
+
+        // Stimulus passes warm up on their own material, so envelopes and
+        // adaptive state have settled on it before timing starts; passes
+        // without FTZ/DAZ warm up too, so denormal tails can build up
+        if (pass.input != nullptr || pass.allowDenormals || pass.automation != nullptr
+            || pass.midiWorkload != nullptr || keyed)
+        {
+            if (keyed)
+                cfg.sidechain->rewind();
+            if (pass.input != nullptr)
+                pass.input->rewind();
+            if (pass.automation != nullptr)
+                pass.automation->rewind();
+            if (pass.midiWorkload != nullptr)
+                pass.midiWorkload->rewind();
+            for (int i = 0; i < cfg.warmupIterations; ++i)
+            {
+                midi.clear();
+                if (pass.input != nullptr)
+                    pass.input->fill(buf);
+                if (pass.automation != nullptr)
+                    pass.automation->next();
+                if (pass.midiWorkload != nullptr)
+                {
+                    buf.clear();
+                    if (i == 0)
+                        pass.midiWorkload->prelude(midi);
+                    pass.midiWorkload->next(midi);
+                }
+                if (keyed)
+                    cfg.sidechain->fill(sidechainView);
+                plug.processBlock(buf, midi);
+            }
+        }
+
+        // Cold pass: thrash the caches (and optionally flush our own buffers)
+        std::unique_ptr<CacheEvictor> evictor;
+        if (pass.evictCaches)
+            evictor = std::make_unique<CacheEvictor>(cfg.evictBytes);
+
+        // Paced mode: one callback per period, with idle time in between
+        PeriodPacer pacer(cfg.pacing, (double) block / sr);
+        LatencyHistogram jitterNs;
+        pacer.start();
+        const bool jobPerBlock = cfg.schedPolicy == SchedPolicy::Deadline && cfg.pacing == PacingMode::None;
+
+        // Timed iterations (everything except processBlock stays outside the timed region)
         for (int i = 0; i < iters; ++i)
         {
             midi.clear();
-            const int64 t0 = Time::getHighResolutionTicks();
+            if (pass.input != nullptr)
+                pass.input->fill(buf);
+            if (pass.automation != nullptr)
+                pass.automation->next();
+            if (pass.midiWorkload != nullptr)
+            {
+                // Instrument track: silent buffer in, this block's events
+                buf.clear();
+                pass.midiWorkload->next(midi);
+            }
+            if (keyed)
+                cfg.sidechain->fill(sidechainView);
+            if (evictor != nullptr)
+            {
+                evictor->evict();
+                if (cfg.flushIoBuffers)
+                    for (int c = 0; c < buf.getNumChannels(); ++c)
+                        CacheEvictor::flushRange(buf.getReadPointer(c), sizeof(Sample) * (size_t) block);
+            }
+            if (cfg.pacing != PacingMode::None)
+                jitterNs.record(pacer.waitForDeadline());
+            else if (jobPerBlock)
+                RealtimeScheduling::endDeadlineJob(); // after the untimed set-up, so the block gets a whole runtime
+            if (osProbe.isOpen()) osBefore = osProbe.read();
+            if (counters.isOpen()) counters.read(before);
+            if (cfg.rtAudit) RtAudit::begin();
+            const int64 t0 = timer.start();
             plug.processBlock(buf, midi);
-            const int64 t1 = Time::getHighResolutionTicks();
-            us.push_back((double)(t1 - t0) * 1e6 / tps);
+            const int64 t1 = timer.stop();
+            if (cfg.rtAudit)
+            {
+                const RtAudit::Counts c = RtAudit::end();
+                auditTotals.allocs += c.allocs;
+                auditTotals.frees += c.frees;
+                auditTotals.allocBytes += c.allocBytes;
+                auditTotals.lockOps += c.lockOps;
+                auditTotals.condOps += c.condOps;
+                auditTotals.syscalls += jmax((int64) 0, c.syscalls);
+                if (c.any()) ++unsafeBlocks;
+
+                // backtrace() ran inside the timed region, so this block's time
+                // is not the plugin's; it is counted in the audit but not timed
+                if (c.backtraces > 0)
+                {
+                    ++tracedBlocks;
+                    if (cfg.pacing != PacingMode::None)
+                        pacer.finishPeriod();
+                    continue;
+                }
+            }
+            if (counters.isOpen())
+            {
+                counters.read(after);
+                for (size_t c = 0; c < totals.size(); ++c)
+                    totals[c] += after[c] - before[c];
+            }
+            const int64 elapsed = t1 - t0;
+            if (osProbe.isOpen())
+            {
+                const OsNoiseProbe::Sample os = osProbe.read() - osBefore;
+                osTotals += os;
+                outliers.offer(i, elapsed, os);
+                if (os.any()) { ++noisyBlocks; noisyTicks += elapsed; }
+                else quietHist.record(elapsed);
+            }
+            if (cfg.pacing != PacingMode::None)
+                pacer.finishPeriod();
+            hist.record(elapsed);
+            if (elapsed > budgetTicks) ++misses;
+            for (size_t f = 0; f < fractionTicks.size(); ++f)
+                if (elapsed > fractionTicks[f]) ++overFraction[f];
         }
         
-        std::sort(us.begin(), us.end());
-        
-        auto pick = [&](double q) {
-            if (us.empty()) return 0.0;
-            const double idxF = q * (double)(us.size() - 1);
-            size_t idx = (size_t) std::clamp(idxF, 0.0, (double)us.size() - 1.0);
-            return us[idx];
-        };
-        
-        double mean = 0.0;
-        for (double v : us) mean += v;
-        if (!us.empty()) mean /= (double)us.size();
+        const int timedBlocks = iters - tracedBlocks;
+        if (tracedBlocks > 0)
+            std::cerr << "NOTE " << tag << ": " << tracedBlocks << " blocks that captured a backtrace are left out of the timing\n";
+
+        auto pick = [&](double q) { return hist.valueAtQuantile(q) * usPerTick; };
         
+        const double mean = hist.mean() * usPerTick;
         const double median = pick(0.5);
         const double p95 = pick(0.95);
-        const double mn = us.empty() ? 0.0 : us.front();
-        const double mx = us.empty() ? 0.0 : us.back();
-        
-        // Calculate standard deviation
-        double variance = 0.0;
-        if (!us.empty())
-        {
-            for (double v : us)
-            {
-                double diff = v - mean;
-                variance += diff * diff;
-            }
-            variance /= (double)us.size();
-        }
-        const double stdDev = std::sqrt(variance);
+        const double mn = (double) hist.min() * usPerTick;
+        const double mx = (double) hist.max() * usPerTick;
+        const double stdDev = hist.stdDev() * usPerTick;
         
         // Coefficient of variation (relative standard deviation)
         const double cv = (mean > 0.0) ? (stdDev / mean) * 100.0 : 0.0;
         
-        const double rtWindow_us = (double)block * 1e6 / sr;
         const double rtPct = rtWindow_us > 0 ? (mean / rtWindow_us) * 100.0 : 0.0;
         
         // Plugin Doctor style: processing time per sample as % of sample period
@@ -196,33 +628,151 @@ private:
         // Measurement consistency checks (warnings to stderr)
         if (mn > median || median > mean)
         {
-            std::cerr << "WARNING [buffer=" << block << "]: Sanity check failed - "
+            std::cerr << "WARNING " << tag << ": Sanity check failed - "
                       << "min=" << mn << " median=" << median << " mean=" << mean << "\n";
         }
         
         if (median > 0 && (p95 / median) > 3.0)
         {
-            std::cerr << "WARNING [buffer=" << block << "]: High outlier ratio - "
+            std::cerr << "WARNING " << tag << ": High outlier ratio - "
                       << "p95/median=" << (p95/median) << " (suggests measurement instability)\n";
         }
         
         if (cv > 30.0)
         {
-            std::cerr << "WARNING [buffer=" << block << "]: High coefficient of variation - "
+            std::cerr << "WARNING " << tag << ": High coefficient of variation - "
                       << "CV=" << cv << "% (consider more iterations or warmup)\n";
         }
         
+        if (misses > 0)
+        {
+            std::cerr << "WARNING " << tag << ": " << misses << " of " << timedBlocks
+                      << " blocks missed the " << rtWindow_us << "us deadline (max=" << mx << "us)\n";
+        }
+
+        if (pacer.xruns() > 0)
+        {
+            std::cerr << "WARNING " << tag << ": " << pacer.xruns()
+                      << " xruns in paced mode (" << PeriodPacer::modeName(cfg.pacing) << ")\n";
+        }
+
+        if (cfg.rtAudit)
+        {
+            if (unsafeBlocks > 0)
+            {
+                std::cerr << "WARNING " << tag << ": processBlock is not real-time safe in " << unsafeBlocks
+                          << " of " << iters << " blocks - " << auditTotals.allocs << " allocs, "
+                          << auditTotals.frees << " frees, " << auditTotals.lockOps << " lock ops, "
+                          << auditTotals.condOps << " condvar ops";
+                if (syscallCounter) std::cerr << ", " << auditTotals.syscalls << " syscalls";
+                std::cerr << "\n";
+            }
+            RtAudit::printBacktraces(tag);
+            RtAudit::closeSyscallCounter();
+        }
+
+        if (osProbe.isOpen())
+        {
+            // Slowest blocks with what the OS did during each of them
+            for (const auto& o : outliers.sorted())
+            {
+                std::cerr << "OS-NOISE " << tag << ": block " << o.iteration << " took "
+                          << (double) o.ticks * usPerTick << "us - minflt=" << o.os.minorFaults
+                          << " majflt=" << o.os.majorFaults << " vcsw=" << o.os.voluntarySwitches
+                          << " ivcsw=" << o.os.involuntarySwitches;
+                if (osProbe.hasRunQueueWait())
+                    std::cerr << " runq_wait=" << (double) o.os.runQueueWaitNs / 1000.0 << "us";
+                std::cerr << (o.os.any() ? "" : " (no OS events: plugin cost)") << "\n";
+            }
+        }
+
         if (mean <= 0 || median <= 0)
         {
-            std::cerr << "ERROR [buffer=" << block << "]: Invalid measurements - "
+            std::cerr << "ERROR " << tag << ": Invalid measurements - "
                       << "mean=" << mean << " median=" << median << "\n";
         }
         
-        plug.releaseResources();
-        
-        return Stats{mean, median, p95, mn, mx, stdDev, cv, rtPct, dspLoad, latency};
+        Stats st {};
+        st.mean = mean;
+        st.median = median;
+        st.p90 = pick(0.90);
+        st.p95 = p95;
+        st.p99 = pick(0.99);
+        st.p999 = pick(0.999);
+        st.p9999 = pick(0.9999);
+        st.min = mn;
+        st.max = mx;
+        st.stdDev = stdDev;
+        st.cv = cv;
+        st.rtPct = rtPct;
+        st.dspLoad = dspLoad;
+        st.latency = latency;
+
+        st.maxOverBudget = std::max(0.0, mx - rtWindow_us);
+        st.deadlineMisses = misses;
+        st.deadlineMissRate = timedBlocks > 0 ? (double) misses / (double) timedBlocks : 0.0;
+        st.overBudgetFraction = overFraction;
+        for (uint64 n : overFraction)
+            st.overBudgetFractionRate.push_back(timedBlocks > 0 ? (double) n / (double) timedBlocks : 0.0);
+
+        st.paced = cfg.pacing != PacingMode::None;
+        st.wakeJitterMean = jitterNs.mean() / 1000.0;
+        st.wakeJitterP99 = jitterNs.valueAtQuantile(0.99) / 1000.0;
+        st.wakeJitterMax = (double) jitterNs.max() / 1000.0;
+        st.xruns = pacer.xruns();
+
+        st.rtAudit = cfg.rtAudit;
+        st.rtAllocs = auditTotals.allocs;
+        st.rtFrees = auditTotals.frees;
+        st.rtAllocBytes = auditTotals.allocBytes;
+        st.rtLockOps = auditTotals.lockOps;
+        st.rtCondOps = auditTotals.condOps;
+        st.rtSyscalls = syscallCounter ? auditTotals.syscalls : -1;
+        st.rtUnsafeBlocks = unsafeBlocks;
+
+        st.osNoise = osProbe.isOpen();
+        st.osMinorFaults = osTotals.minorFaults;
+        st.osMajorFaults = osTotals.majorFaults;
+        st.osVoluntarySwitches = osTotals.voluntarySwitches;
+        st.osInvoluntarySwitches = osTotals.involuntarySwitches;
+        st.osRunQueueWait = (double) osTotals.runQueueWaitNs / 1000.0;
+        st.osNoisyBlocks = noisyBlocks;
+        st.osNoisyMean = noisyBlocks > 0 ? (double) noisyTicks / (double) noisyBlocks * usPerTick : 0.0;
+        st.osQuietMean = quietHist.mean() * usPerTick;
+        st.osQuietP99 = quietHist.valueAtQuantile(0.99) * usPerTick;
+
+        if (counters.isOpen())
+        {
+            const double n = timedBlocks > 0 ? (double) timedBlocks : 1.0;
+            st.hwCounters = true;
+            for (int c = 0; c < PerfCounterGroup::NumCounters; ++c)
+                st.hwAvailable[(size_t) c] = counters.isAvailable((PerfCounterGroup::Counter) c);
+            st.hwCycles = (double) totals[PerfCounterGroup::Cycles] / n;
+            st.hwInstructions = (double) totals[PerfCounterGroup::Instructions] / n;
+            st.ipc = st.hwCycles > 0.0 ? st.hwInstructions / st.hwCycles : 0.0;
+            st.branchMisses = (double) totals[PerfCounterGroup::BranchMisses] / n;
+            st.l1dMisses = (double) totals[PerfCounterGroup::L1dMisses] / n;
+            st.llcMisses = (double) totals[PerfCounterGroup::LlcMisses] / n;
+            st.dtlbMisses = (double) totals[PerfCounterGroup::DtlbMisses] / n;
+        }
+
+        return st;
     }
     
+    /**
+     * Request the configured policy for the calling thread. Failures are reported
+     * but not fatal; the granted policy is recorded in the result either way.
+     */
+    static void applySchedPolicy(const BenchmarkConfig& cfg)
+    {
+        String error;
+        const int64 periodNs = (int64) ((double) cfg.blockSize * 1.0e9 / cfg.sampleRate);
+
+        if (! RealtimeScheduling::applyPolicy(cfg.schedPolicy, cfg.rtPriority, periodNs,
+                                              cfg.deadlineRuntimePct, error))
+            std::cerr << "WARNING: " << error << "\n";
+    }
+
     static Thread::RealtimeOptions createRealtimeOptions(const BenchmarkConfig& cfg)
     {
         Thread::RealtimeOptions opts;
@@ -0,0 +1,332 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "block_timer.hpp"
+#include "latency_histogram.hpp"
+#include "param_automation.hpp"
+#include "phase_report.hpp"
+#include "rt_scheduling.hpp"
+#include "signal_generator.hpp"
+
+using namespace juce;
+
+enum class BlockPattern { Random, Split, Trace };
+
+/**
+ * Block sizes a host hands to processBlock, call by call, never above the
+ * prepared maximum.
+ *
+ * Random: uniform in [minBlock, maxBlock], seeded, as hosts that follow
+ * their own scheduling (FL Studio, live loopers) produce.
+ * Split: fixed host periods of maxBlock cut at automation points that fall
+ * at splitRate per second (uniform in time), as sample-accurate hosts do.
+ * Each sub-block that starts at a point is flagged, so the caller can move
+ * parameters right before it.
+ * Trace: sizes read from a recorded host log (integers separated by spaces,
+ * commas or newlines; '#' starts a comment), looped; entries above the
+ * maximum are cut into maxBlock-sized calls.
+ */
+class BlockStream {
+public:
+    struct Call {
+        int size;
+        bool automationPoint;  // Split: a parameter change lands at the start of this call
+    };
+
+    static bool parsePattern(const std::string& s, BlockPattern& out) {
+        if (s == "random") out = BlockPattern::Random;
+        else if (s == "split") out = BlockPattern::Split;
+        else if (s == "trace") out = BlockPattern::Trace;
+        else return false;
+        return true;
+    }
+
+    static const char* name(BlockPattern p) {
+        switch (p) {
+            case BlockPattern::Random: return "random";
+            case BlockPattern::Split:  return "split";
+            case BlockPattern::Trace:  return "trace";
+        }
+        return "?";
+    }
+
+    /** Reads a host trace; false if the file holds no positive size. */
+    static bool loadTrace(const File& file, std::vector<int>& sizes, String& error) {
+        sizes.clear();
+        StringArray lines;
+        lines.addLines(file.loadFileAsString());
+        for (auto line : lines) {
+            line = line.upToFirstOccurrenceOf("#", false, false);
+            StringArray tokens;
+            tokens.addTokens(line, " ,\t;", "");
+            for (const auto& t : tokens) {
+                const int n = t.trim().getIntValue();
+                if (n > 0) sizes.push_back(n);
+            }
+        }
+        if (sizes.empty()) {
+            error = "no block sizes in " + file.getFullPathName();
+            return false;
+        }
+        return true;
+    }
+
+    /** Generates at least `calls` calls for one prepared maximum. */
+    static std::vector<Call> generate(BlockPattern pattern, int maxBlock, int calls, int minBlock,
+                                      double splitRate, double sampleRate, const std::vector<int>& trace)
+    {
+        std::vector<Call> out;
+        out.reserve((size_t) calls);
+        Random rng(2024);
+        const int lo = jlimit(1, maxBlock, minBlock);
+
+        switch (pattern) {
+            case BlockPattern::Random:
+                while ((int) out.size() < calls)
+                    out.push_back({ lo + rng.nextInt(maxBlock - lo + 1), false });
+                break;
+
+            case BlockPattern::Split: {
+                // Exponential gaps give a Poisson stream of automation points
+                const double meanGap = splitRate > 0.0 ? sampleRate / splitRate : 0.0;
+                auto gap = [&] { return meanGap > 0.0 ? -std::log(1.0 - rng.nextDouble()) * meanGap : 1.0e300; };
+                double nextPoint = gap();
+                double periodStart = 0.0;
+
+                while ((int) out.size() < calls) {
+                    const double periodEnd = periodStart + maxBlock;
+                    double pos = periodStart;
+                    bool atPoint = false;
+                    while (nextPoint < periodEnd) {
+                        const int cut = (int) (std::floor(nextPoint) - pos);
+                        if (cut > 0) {
+                            out.push_back({ cut, atPoint });
+                            pos += cut;
+                        }
+                        atPoint = true;
+                        nextPoint += gap();
+                    }
+                    out.push_back({ (int) (periodEnd - pos), atPoint });
+                    periodStart = periodEnd;
+                }
+                break;
+            }
+
+            case BlockPattern::Trace:
+                for (size_t i = 0; (int) out.size() < calls && ! trace.empty(); i = (i + 1) % trace.size()) {
+                    for (int left = trace[i]; left > 0; left -= maxBlock)
+                        out.push_back({ jmin(left, maxBlock), false });
+                }
+                break;
+        }
+        return out;
+    }
+};
+
+struct BlockStreamConfig {
+    AudioPluginInstance* plugin = nullptr;  // configured, unprepared; prepared per maximum here
+    int maxBlock = 0;
+    int channels = 0;
+    double sampleRate = 0.0;
+    int warmupCalls = 0;
+    int timedCalls = 0;
+    bool useDoublePrecision = false;
+    bool nonRealtime = false;
+    TimerBackend timer = TimerBackend::Juce;
+    BlockPattern pattern = BlockPattern::Random;
+    int minBlock = 1;
+    double splitRate = 200.0;
+    std::vector<int> trace;
+    ParameterAutomation* automation = nullptr; // Split: moved at every automation point
+    bool fifo = false;               // SCHED_FIFO for the calls, not for prepareToPlay
+    int rtPriority = 80;
+};
+
+/** Calls whose size falls in [minSize, maxSize]; times in us. */
+struct BlockSizeBucket {
+    int minSize = 0, maxSize = 0;
+    uint64 calls = 0;
+    int64 samples = 0;
+    double meanCall = 0.0, p99Call = 0.0, maxCall = 0.0;
+    double nsPerSample = 0.0;
+    uint64 misses = 0;  // calls slower than their own size / sr
+};
+
+struct BlockStreamResult {
+    BlockSizeBucket fixed;                // every call at maxBlock, the reference
+    std::vector<BlockSizeBucket> buckets; // power-of-two size ranges that saw calls
+    BlockSizeBucket all;                  // the whole variable stream
+    double callOverheadUs = 0.0;          // least-squares intercept of call time over size
+    double fitNsPerSample = 0.0;          // ... and its slope
+    std::string schedPolicy;              // as granted while processing
+};
+
+/**
+ * Variable block sizes against one prepared maximum. The plugin is prepared
+ * once with maxBlock; first a fixed run of maxBlock calls gives the
+ * reference cost per sample, then the stream is played with a view of the
+ * first n samples of the same buffer. Refilling the input, moving
+ * parameters and building the view all happen outside the timed region.
+ *
+ * Calls are grouped in power-of-two size buckets (1, 2-3, 4-7, ...), and a
+ * straight line time = overhead + size * cost is fitted over every call. A
+ * large intercept means a fixed cost per processBlock that small blocks pay
+ * again and again.
+ *
+ * Runs on the calling thread; with BlockStreamConfig::fifo it is SCHED_FIFO
+ * for the calls only and gets its previous policy back before
+ * releaseResources().
+ */
+class VariableBlockBenchmark {
+public:
+    static BlockStreamResult measure(const BlockStreamConfig& cfg)
+    {
+        auto& plug = *cfg.plugin;
+        plug.releaseResources();
+        plug.setNonRealtime(cfg.nonRealtime);
+        PhaseReport::enter("prepare");
+        plug.prepareToPlay(cfg.sampleRate, cfg.maxBlock);
+        PhaseReport::enter("process");
+
+        BlockStreamResult r;
+        {
+            const ScopedSchedulingState restoreScheduling;
+            String error;
+            if (cfg.fifo && ! RealtimeScheduling::applyFifo(cfg.rtPriority, error))
+                std::cerr << "WARNING: " << error << "\n";
+            const std::string granted = RealtimeScheduling::describeCurrentThread();
+
+            r = cfg.useDoublePrecision ? run<double>(cfg) : run<float>(cfg);
+            r.schedPolicy = granted;
+        }
+
+        plug.releaseResources();
+        return r;
+    }
+
+private:
+    static int bucketIndex(int size) {
+        int b = 0;
+        while ((2 << b) <= size) ++b;
+        return b;
+    }
+
+    template <typename Sample>
+    static BlockStreamResult run(const BlockStreamConfig& cfg)
+    {
+        ScopedNoDenormals noDenormals;
+
+        auto& plug = *cfg.plugin;
+        const auto calls = BlockStream::generate(cfg.pattern, cfg.maxBlock, cfg.warmupCalls + cfg.timedCalls,
+                                                 cfg.minBlock, cfg.splitRate, cfg.sampleRate, cfg.trace);
+
+        AudioBuffer<Sample> buf(cfg.channels, cfg.maxBlock);
+        MidiBuffer midi;
+        SignalGenerator input(Stimulus::White, cfg.sampleRate, cfg.channels);
+
+        const BlockTimer timer(cfg.timer);
+        const double usPerTick = timer.ticksToMicros(1);
+
+        auto callOnce = [&](int n) -> int64 {
+            AudioBuffer<Sample> view(buf.getArrayOfWritePointers(), cfg.channels, n);
+            input.fill(view);
+            midi.clear();
+            const int64 t0 = timer.start();
+            plug.processBlock(view, midi);
+            const int64 t1 = timer.stop();
+            return t1 - t0;
+        };
+
+        auto summarise = [&](BlockSizeBucket& b, const LatencyHistogram& h) {
+            b.meanCall = h.mean() * usPerTick;
+            b.p99Call = h.valueAtQuantile(0.99) * usPerTick;
+            b.maxCall = (double) h.max() * usPerTick;
+            b.nsPerSample = b.samples > 0 ? h.mean() * (double) b.calls * usPerTick * 1000.0 / (double) b.samples : 0.0;
+        };
+
+        BlockStreamResult r;
+
+        // Reference: the same number of calls, all at the prepared maximum
+        {
+            LatencyHistogram hist;
+            const int64 budget = (int64) ((double) cfg.maxBlock * 1e6 / cfg.sampleRate / usPerTick);
+            for (int i = 0; i < cfg.warmupCalls; ++i)
+                callOnce(cfg.maxBlock);
+            for (int i = 0; i < cfg.timedCalls; ++i) {
+                const int64 t = callOnce(cfg.maxBlock);
+                hist.record(t);
+                if (t > budget) ++r.fixed.misses;
+            }
+            r.fixed.minSize = r.fixed.maxSize = cfg.maxBlock;
+            r.fixed.calls = (uint64) cfg.timedCalls;
+            r.fixed.samples = (int64) cfg.timedCalls * cfg.maxBlock;
+            summarise(r.fixed, hist);
+        }
+
+        const int numBuckets = bucketIndex(cfg.maxBlock) + 1;
+        std::vector<LatencyHistogram> hists((size_t) numBuckets);
+        std::vector<BlockSizeBucket> buckets((size_t) numBuckets);
+        LatencyHistogram allHist;
+
+        if (cfg.automation != nullptr)
+            cfg.automation->rewind();
+
+        double sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (size_t i = 0; i < calls.size(); ++i) {
+            const auto& c = calls[i];
+            if (c.automationPoint && cfg.automation != nullptr)
+                cfg.automation->next();
+
+            const int64 t = callOnce(c.size);
+            if ((int) i < cfg.warmupCalls) continue;
+
+            const int b = bucketIndex(c.size);
+            hists[(size_t) b].record(t);
+            allHist.record(t);
+
+            auto& bucket = buckets[(size_t) b];
+            ++bucket.calls;
+            bucket.samples += c.size;
+            const bool missed = (double) t * usPerTick > (double) c.size * 1e6 / cfg.sampleRate;
+            if (missed) { ++bucket.misses; ++r.all.misses; }
+            ++r.all.calls;
+            r.all.samples += c.size;
+
+            const double us = (double) t * usPerTick;
+            sx += c.size;
+            sy += us;
+            sxx += (double) c.size * c.size;
+            sxy += c.size * us;
+        }
+
+        if (cfg.automation != nullptr)
+            cfg.automation->restore();
+
+        for (int b = 0; b < numBuckets; ++b) {
+            auto& bucket = buckets[(size_t) b];
+            if (bucket.calls == 0) continue;
+            bucket.minSize = 1 << b;
+            bucket.maxSize = jmin(cfg.maxBlock, (2 << b) - 1);
+            summarise(bucket, hists[(size_t) b]);
+            r.buckets.push_back(bucket);
+        }
+
+        r.all.minSize = r.buckets.empty() ? 0 : r.buckets.front().minSize;
+        r.all.maxSize = cfg.maxBlock;
+        summarise(r.all, allHist);
+
+        const double n = (double) r.all.calls;
+        const double den = n * sxx - sx * sx;
+        if (den > 0.0) {
+            r.fitNsPerSample = (n * sxy - sx * sy) / den * 1000.0;
+            r.callOverheadUs = (sy - r.fitNsPerSample / 1000.0 * sx) / n;
+        }
+        return r;
+    }
+};
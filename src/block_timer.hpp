@@ -0,0 +1,175 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <chrono>
+#include <string>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+ #define PLUGPERF_HAS_TSC 1
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+  #include <cpuid.h>
+ #endif
+#else
+ #define PLUGPERF_HAS_TSC 0
+#endif
+
+using namespace juce;
+
+/**
+ * Clock used to time each processBlock call.
+ *   Juce         - Time::getHighResolutionTicks() (portable default)
+ *   Tsc          - serialized rdtsc/rdtscp (x86 with invariant TSC)
+ *   MonotonicRaw - clock_gettime(CLOCK_MONOTONIC_RAW), immune to NTP slewing
+ */
+enum class TimerBackend {
+    Juce,
+    Tsc,
+    MonotonicRaw
+};
+
+/**
+ * Reads raw ticks from the selected backend and converts them to
+ * microseconds.
+ *
+ * Unavailable backends fall back at construction (Tsc -> MonotonicRaw -> Juce),
+ * so backend() always reports what is really being used.
+ */
+class BlockTimer {
+public:
+    explicit BlockTimer(TimerBackend requested = TimerBackend::Juce) {
+        backend_ = requested;
+
+        if (backend_ == TimerBackend::Tsc && !hasInvariantTsc())
+            backend_ = TimerBackend::MonotonicRaw;
+
+       #if !defined(CLOCK_MONOTONIC_RAW)
+        if (backend_ == TimerBackend::MonotonicRaw)
+            backend_ = TimerBackend::Juce;
+       #endif
+
+        switch (backend_) {
+            case TimerBackend::Tsc:          ticksPerSecond_ = tscHz(); break;
+            case TimerBackend::MonotonicRaw: ticksPerSecond_ = 1.0e9; break;
+            case TimerBackend::Juce:         ticksPerSecond_ = (double) Time::getHighResolutionTicksPerSecond(); break;
+        }
+    }
+
+    TimerBackend backend() const { return backend_; }
+
+    const char* name() const { return backendName(backend_); }
+
+    /** Timestamp taken before the timed region. */
+    inline int64 start() const {
+       #if PLUGPERF_HAS_TSC
+        if (backend_ == TimerBackend::Tsc) {
+            // lfence on both sides keeps earlier work from leaking into the
+            // region and the timed code from starting before the read
+            _mm_lfence();
+            const int64 t = (int64) __rdtsc();
+            _mm_lfence();
+            return t;
+        }
+       #endif
+        return readNonTsc();
+    }
+
+    /** Timestamp taken after the timed region. */
+    inline int64 stop() const {
+       #if PLUGPERF_HAS_TSC
+        if (backend_ == TimerBackend::Tsc) {
+            // rdtscp waits for the timed code to retire; the trailing lfence
+            // stops later instructions from executing ahead of the read
+            unsigned int aux = 0;
+            const int64 t = (int64) __rdtscp(&aux);
+            _mm_lfence();
+            return t;
+        }
+       #endif
+        return readNonTsc();
+    }
+
+    double ticksToMicros(int64 ticks) const { return (double) ticks * 1.0e6 / ticksPerSecond_; }
+
+    static const char* backendName(TimerBackend b) {
+        switch (b) {
+            case TimerBackend::Tsc:          return "tsc";
+            case TimerBackend::MonotonicRaw: return "monotonic-raw";
+            case TimerBackend::Juce:         return "juce";
+        }
+        return "juce";
+    }
+
+    static bool parseBackend(const std::string& name, TimerBackend& out) {
+        if (name == "juce")          { out = TimerBackend::Juce;         return true; }
+        if (name == "tsc")           { out = TimerBackend::Tsc;          return true; }
+        if (name == "monotonic-raw") { out = TimerBackend::MonotonicRaw; return true; }
+        return false;
+    }
+
+    /** CPUID.80000007H:EDX[8] - TSC ticks at a constant rate in all P/C-states. */
+    static bool hasInvariantTsc() {
+       #if PLUGPERF_HAS_TSC
+        #if defined(_MSC_VER)
+         int regs[4] {};
+         __cpuid(regs, 0x80000000);
+         if ((unsigned int) regs[0] < 0x80000007u) return false;
+         __cpuid(regs, 0x80000007);
+         return (regs[3] & (1 << 8)) != 0;
+        #else
+         unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+         if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u) return false;
+         __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+         return (edx & (1u << 8)) != 0;
+        #endif
+       #else
+        return false;
+       #endif
+    }
+
+    /**
+     * TSC frequency, calibrated once per process against steady_clock over a
+     * short busy-wait. Returns 0 when there is no usable TSC.
+     */
+    static double tscHz() {
+        static const double hz = calibrateTscHz();
+        return hz;
+    }
+
+private:
+    inline int64 readNonTsc() const {
+       #if defined(CLOCK_MONOTONIC_RAW)
+        if (backend_ == TimerBackend::MonotonicRaw) {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+            return (int64) ts.tv_sec * 1000000000LL + (int64) ts.tv_nsec;
+        }
+       #endif
+        return Time::getHighResolutionTicks();
+    }
+
+    static double calibrateTscHz() {
+       #if PLUGPERF_HAS_TSC
+        if (!hasInvariantTsc()) return 0.0;
+
+        using clock = std::chrono::steady_clock;
+        const auto window = std::chrono::milliseconds(50);
+
+        const auto c0 = clock::now();
+        const uint64 t0 = __rdtsc();
+        while (clock::now() - c0 < window) {}
+        const auto c1 = clock::now();
+        const uint64 t1 = __rdtsc();
+
+        const double seconds = std::chrono::duration<double>(c1 - c0).count();
+        return seconds > 0.0 ? (double) (t1 - t0) / seconds : 0.0;
+       #else
+        return 0.0;
+       #endif
+    }
+
+    TimerBackend backend_ = TimerBackend::Juce;
+    double ticksPerSecond_ = 1.0;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+ #include <emmintrin.h>
+#endif
+
+using namespace juce;
+
+/**
+ * Pushes plugin state out of the CPU caches between timed iterations.
+ *
+ * evict() writes one byte per cache line across a thrash buffer. Writing (not
+ * just reading) leaves the lines dirty, so the plugin's lines are evicted from
+ * every level the buffer is larger than. The buffer should be larger than the
+ * last-level cache. It runs on the measuring thread, so it thrashes the
+ * caches of the core the plugin is about to run on.
+ */
+class CacheEvictor {
+public:
+    static constexpr size_t lineSize = 64;
+
+    explicit CacheEvictor(size_t bytes) : buffer_(bytes, 0) {}
+
+    void evict() {
+        uint8* data = buffer_.data();
+        const size_t n = buffer_.size();
+
+        for (size_t i = 0; i < n; i += lineSize)
+            data[i] = (uint8) (data[i] + 1);
+
+        // Keep the compiler from discarding the stores
+        sink_ = sink_ + (n > 0 ? data[n - 1] : 0);
+    }
+
+    /**
+     * Flush an address range from all cache levels (clflush on x86,
+     * dc civac on AArch64). Other architectures fall back to no-op.
+     */
+    static void flushRange(const void* ptr, size_t bytes) {
+        const auto start = reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t) (lineSize - 1);
+        const auto end = reinterpret_cast<uintptr_t>(ptr) + bytes;
+
+       #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        for (uintptr_t p = start; p < end; p += lineSize)
+            _mm_clflush(reinterpret_cast<const void*>(p));
+        _mm_mfence();
+       #elif defined(__aarch64__)
+        for (uintptr_t p = start; p < end; p += lineSize)
+            asm volatile("dc civac, %0" :: "r"(p) : "memory");
+        asm volatile("dsb ish" ::: "memory");
+       #else
+        ignoreUnused(start, end);
+       #endif
+    }
+
+    size_t size() const { return buffer_.size(); }
+
+private:
+    std::vector<uint8> buffer_;
+    volatile uint8 sink_ = 0;
+};
@@ -0,0 +1,198 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "block_timer.hpp"
+#include "latency_histogram.hpp"
+#include "rt_scheduling.hpp"
+
+using namespace juce;
+
+struct ChainConfig {
+    std::vector<AudioPluginInstance*> plugins; // processing order, owned by the caller
+    int blockSize = 0;
+    int channels = 0;
+    double sampleRate = 0.0;
+    int warmupIterations = 0;
+    int timedIterations = 0;
+    bool useDoublePrecision = false;
+    bool nonRealtime = false;
+    TimerBackend timer = TimerBackend::Juce;
+    bool fifo = false;               // SCHED_FIFO for the processing, not for prepareToPlay
+    int rtPriority = 80;
+};
+
+/** One insert, measured alone and inside the chain. */
+struct ChainSlotStats {
+    double isolatedMean = 0.0, isolatedP99 = 0.0;  // us, plugin alone on a warm buffer
+    double chainMean = 0.0, chainP99 = 0.0, chainMax = 0.0; // us, same plugin inside the chain
+};
+
+struct ChainResult {
+    std::vector<ChainSlotStats> slots;
+    double isolatedSum = 0.0;       // sum of isolated means
+    double chainMean = 0.0, chainP99 = 0.0, chainMax = 0.0; // us, whole chain per block
+    double budget = 0.0;            // us, block / sr
+    uint64 deadlineMisses = 0;      // chain blocks slower than the budget
+    double deadlineMissRate = 0.0;
+    std::string schedPolicy;        // as granted while processing
+};
+
+/**
+ * Serial insert chain sharing one AudioBuffer, as on a DAW track.
+ *
+ * Every plugin is first measured alone (warmup + timed iterations on its own
+ * copy of the input). Then the whole chain runs on one buffer and a single
+ * timestamp is taken between neighbouring inserts, so the per-plugin times
+ * add up exactly to the chain total. Comparing the two shows what the
+ * plugins cost each other through shared caches, which an isolated
+ * benchmark cannot see.
+ *
+ * Everything runs on the calling thread. With ChainConfig::fifo it is
+ * SCHED_FIFO from the first processBlock() to the last and back to its
+ * previous policy before the plugins are released.
+ */
+class ChainBenchmark {
+public:
+    static ChainResult measure(const ChainConfig& cfg)
+    {
+        return cfg.useDoublePrecision ? measureImpl<double>(cfg) : measureImpl<float>(cfg);
+    }
+
+private:
+    template <typename Sample>
+    static void fillInput(AudioBuffer<Sample>& buf)
+    {
+        // Deterministic input so SIMD/branches get exercised
+        Random rng(12345);
+        for (int c = 0; c < buf.getNumChannels(); ++c)
+            for (int n = 0; n < buf.getNumSamples(); ++n)
+                buf.setSample(c, n, (Sample)((rng.nextFloat() * 2.0f - 1.0f) * 0.1f));
+    }
+
+    template <typename Sample>
+    static ChainResult measureImpl(const ChainConfig& cfg)
+    {
+        ScopedNoDenormals noDenormals;
+
+        const size_t count = cfg.plugins.size();
+        const BlockTimer timer(cfg.timer);
+        const double usPerTick = timer.ticksToMicros(1);
+
+        ChainResult result;
+        result.slots.resize(count);
+        result.budget = (double) cfg.blockSize * 1e6 / cfg.sampleRate;
+        const int64 budgetTicks = (int64) (result.budget / usPerTick);
+
+        for (auto* plugin : cfg.plugins)
+        {
+            plugin->releaseResources();
+            plugin->setNonRealtime(cfg.nonRealtime);
+            plugin->prepareToPlay(cfg.sampleRate, cfg.blockSize);
+        }
+
+        std::unique_ptr<ScopedSchedulingState> restoreScheduling;
+        if (cfg.fifo)
+        {
+            restoreScheduling = std::make_unique<ScopedSchedulingState>();
+            String error;
+            if (! RealtimeScheduling::applyFifo(cfg.rtPriority, error))
+                std::cerr << "WARNING: " << error << "\n";
+        }
+        result.schedPolicy = RealtimeScheduling::describeCurrentThread();
+
+        AudioBuffer<Sample> buf(cfg.channels, cfg.blockSize);
+        MidiBuffer midi;
+
+        // Isolated: each plugin alone, as the single-plugin mode measures it
+        for (size_t p = 0; p < count; ++p)
+        {
+            auto& plug = *cfg.plugins[p];
+            fillInput(buf);
+
+            for (int i = 0; i < cfg.warmupIterations; ++i)
+            {
+                midi.clear();
+                plug.processBlock(buf, midi);
+            }
+
+            LatencyHistogram hist;
+            for (int i = 0; i < cfg.timedIterations; ++i)
+            {
+                midi.clear();
+                const int64 t0 = timer.start();
+                plug.processBlock(buf, midi);
+                hist.record(timer.stop() - t0);
+            }
+
+            result.slots[p].isolatedMean = hist.mean() * usPerTick;
+            result.slots[p].isolatedP99 = hist.valueAtQuantile(0.99) * usPerTick;
+            result.isolatedSum += result.slots[p].isolatedMean;
+        }
+
+        // Chain: one buffer through every insert, one timestamp per boundary
+        fillInput(buf);
+
+        for (int i = 0; i < cfg.warmupIterations; ++i)
+        {
+            for (auto* plugin : cfg.plugins)
+            {
+                midi.clear();
+                plugin->processBlock(buf, midi);
+            }
+        }
+
+        std::vector<LatencyHistogram> perSlot(count);
+        LatencyHistogram total;
+        std::vector<int64> stamps(count + 1);
+
+        for (int i = 0; i < cfg.timedIterations; ++i)
+        {
+            stamps[0] = timer.start();
+            for (size_t p = 0; p < count; ++p)
+            {
+                midi.clear();
+                cfg.plugins[p]->processBlock(buf, midi);
+                stamps[p + 1] = timer.stop();
+            }
+
+            for (size_t p = 0; p < count; ++p)
+                perSlot[p].record(stamps[p + 1] - stamps[p]);
+
+            const int64 elapsed = stamps[count] - stamps[0];
+            total.record(elapsed);
+            if (elapsed > budgetTicks) ++result.deadlineMisses;
+        }
+
+        for (size_t p = 0; p < count; ++p)
+        {
+            result.slots[p].chainMean = perSlot[p].mean() * usPerTick;
+            result.slots[p].chainP99 = perSlot[p].valueAtQuantile(0.99) * usPerTick;
+            result.slots[p].chainMax = (double) perSlot[p].max() * usPerTick;
+        }
+
+        result.chainMean = total.mean() * usPerTick;
+        result.chainP99 = total.valueAtQuantile(0.99) * usPerTick;
+        result.chainMax = (double) total.max() * usPerTick;
+        result.deadlineMissRate = cfg.timedIterations > 0
+                                    ? (double) result.deadlineMisses / (double) cfg.timedIterations : 0.0;
+
+        if (result.deadlineMisses > 0)
+        {
+            std::cerr << "WARNING [chain, buffer=" << cfg.blockSize << "]: " << result.deadlineMisses
+                      << " of " << cfg.timedIterations << " blocks missed the " << result.budget
+                      << "us deadline (max=" << result.chainMax << "us)\n";
+        }
+
+        restoreScheduling.reset();
+        for (auto* plugin : cfg.plugins)
+            plugin->releaseResources();
+
+        return result;
+    }
+};
@@ -4,6 +4,7 @@
 #include <memory>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 // Minimal CSV writer for plugperf
 // Usage:
@@ -24,15 +25,120 @@ struct CsvSink {
         return true;
     }
 
+    // Column label for a budget fraction, e.g. 0.5 -> "50", 0.125 -> "12.5"
+    static std::string budgetLabel(double fraction) {
+        std::ostringstream ss;
+        ss << fraction * 100.0;
+        return ss.str();
+    }
+
     // Column order must match what main.cpp writes
-    void header() {
+    void header(const std::vector<double>& budgetFractions) {
+        (*out)
+            << "plugin_name,plugin_path,format,sr,channels,channel_layout,bit_depth,warmup,iterations,block_size,"
+            << "scenario,mean_vs_default,ftz,no_ftz_slowdown,midi_polyphony,midi_events_per_block,midi_peak_voices,midi_mean_voices,sidechain,sidechain_channels,sidechain_slowdown,"
+            << "mean_us,median_us,p90_us,p95_us,p99_us,p99_9_us,p99_99_us,min_us,max_us,std_dev_us,cv_pct,"
+            << "approx_rt_cpu_pct,dsp_load_pct,latency_samples,sched_policy,"
+            << "max_over_budget_us,deadline_misses,deadline_miss_rate,";
+        for (double f : budgetFractions)
+            (*out) << "over_" << budgetLabel(f) << "pct_budget,over_" << budgetLabel(f) << "pct_budget_rate,";
+        (*out)
+            << "paced,wake_jitter_mean_us,wake_jitter_p99_us,wake_jitter_max_us,xruns,"
+            << "timer,"
+            << "hw_cycles,hw_instructions,ipc,branch_misses,l1d_misses,llc_misses,dtlb_misses,"
+            << "rt_allocs,rt_frees,rt_alloc_bytes,rt_lock_ops,rt_cond_ops,rt_syscalls,rt_unsafe_blocks,"
+            << "os_minor_faults,os_major_faults,os_vol_switches,os_invol_switches,os_runq_wait_us,"
+            << "os_noisy_blocks,os_noisy_mean_us,os_quiet_mean_us,os_quiet_p99_us,"
+            << "scan_ms,instantiate_ms,layout_ms,preset_ms,prepare_ms,first_block_us,first_block_vs_mean,"
+            << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // Scaling mode (--scaling): one row per block size and worker-thread count
+    void scalingHeader() {
         (*out)
             << "plugin_name,plugin_path,format,sr,channels,bit_depth,warmup,iterations,block_size,"
-            << "mean_us,median_us,p95_us,min_us,max_us,std_dev_us,cv_pct,"
-            << "approx_rt_cpu_pct,dsp_load_pct,latency_samples,"
+            << "threads,max_instances,instances_per_thread,scaling_efficiency,capped,target_miss_rate,"
+            << "miss_rate,mean_period_us,p99_period_us,max_period_us,budget_us,trials,sched_policy,timer,"
+            << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // Polyphony mode (--polyphony-search): one row per block size
+    void polyphonyHeader() {
+        (*out)
+            << "plugin_name,plugin_path,format,sr,channels,bit_depth,warmup,iterations,block_size,"
+            << "max_voices,capped,target_miss_rate,miss_rate,mean_block_us,p99_block_us,max_block_us,"
+            << "idle_block_us,per_voice_us,per_voice_budget_pct,budget_us,trials,sched_policy,timer,"
+            << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // Channel-sweep mode (--channel-sweep): one row per block size and layout,
+    // then a "fit" row per block size with the per-channel cost
+    void channelSweepHeader() {
+        (*out)
+            << "plugin_name,plugin_path,format,sr,bit_depth,warmup,iterations,block_size,"
+            << "row,channel_layout,channels,mean_us,p99_us,max_us,us_per_channel,marginal_us_per_channel,"
+            << "fit_base_us,fit_us_per_channel,budget_us,deadline_miss_rate,sched_policy,timer,"
+            << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // Block-stream mode (--block-stream): per prepared maximum, a "fixed" reference
+    // row, one row per power-of-two size bucket, then an "all" row with the fit
+    void blockStreamHeader() {
+        (*out)
+            << "plugin_name,plugin_path,format,sr,channels,bit_depth,warmup,iterations,max_block,pattern,"
+            << "bucket,bucket_min,bucket_max,calls,samples,mean_call_us,p99_call_us,max_call_us,"
+            << "ns_per_sample,per_sample_vs_fixed,deadline_misses,deadline_miss_rate,"
+            << "call_overhead_us,fit_ns_per_sample,sched_policy,timer,"
+            << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // Session graph mode (--session): one row per node, then one "(period)" row,
+    // per block size and thread count
+    void graphHeader() {
+        (*out)
+            << "session,sr,channels,bit_depth,warmup,iterations,block_size,threads,node,kind,"
+            << "plugin_count,inputs,mean_us,max_us,work_share_pct,on_critical_path,"
+            << "critical_path_us,total_work_us,parallelism,mean_period_us,p99_period_us,max_period_us,"
+            << "budget_us,period_utilisation_pct,worker_utilisation_pct,deadline_misses,deadline_miss_rate,nodes,"
+            << "sched_policy,timer,cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // Insert-chain mode (several --plugin, or --chain): one row per insert, then
+    // a "total" row, per block size
+    void chainHeader() {
+        (*out)
+            << "chain,sr,channels,bit_depth,warmup,iterations,block_size,position,plugin_name,plugin_path,"
+            << "isolated_mean_us,isolated_p99_us,chain_mean_us,chain_p99_us,chain_max_us,chain_vs_isolated,"
+            << "budget_us,deadline_misses,deadline_miss_rate,sched_policy,timer,"
             << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
     }
 
+    // Lifecycle mode (--lifecycle): one row per load/unload cycle
+    void lifecycleHeader() {
+        (*out)
+            << "plugin_name,plugin_path,format,sr,channels,bit_depth,block_size,cycle,"
+            << "scan_ms,instantiate_ms,layout_ms,preset_ms,prepare_ms,first_block_us,steady_block_us,"
+            << "first_block_vs_steady,load_ms,release_ms,destroy_ms,"
+            << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // Memory mode (--memory): one row per profile stage, then the derived
+    // per_instance/shared/growth rows, which only fill the delta columns
+    void memoryHeader() {
+        (*out)
+            << "plugin_name,plugin_path,format,sr,channels,bit_depth,stage,block_size,instances,cycle,"
+            << "rss_kb,pss_kb,uss_kb,rss_delta_kb,pss_delta_kb,uss_delta_kb,"
+            << "cpu_model,cpu_cores,cpu_speed_mhz,total_ram_gb,os_name\n";
+    }
+
+    // plugperf-batch (batch.csv): one row per plugin, written as each worker
+    // ends; failed rows name the phase, signal or exit status
+    void batchHeader() {
+        (*out)
+            << "plugin_path,status,phase,signal,exit_code,worker,cpus,wall_s,"
+            << "start_s,scan_s,load_s,prepare_s,process_s,rows,csv_path,log_path,message\n";
+    }
+
     void row(const std::vector<std::string>& cols) {
         for (size_t i = 0; i < cols.size(); ++i) {
             // naive CSV escaping for commas and quotes
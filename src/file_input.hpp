@@ -0,0 +1,211 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "signal_generator.hpp"
+
+using namespace juce;
+
+/**
+ * Real program material as benchmark input. A background thread decodes the
+ * files one after another (looping over the list) into a pre-allocated
+ * single-producer/single-consumer ring (AbstractFifo), so fill() on the
+ * measuring thread is only a copy out of memory that is already decoded.
+ *
+ * WAV files are memory-mapped where the format allows it; everything else
+ * goes through the regular AudioFormatReader. Files at a different sample
+ * rate are played without resampling - the material is pitched, but what
+ * the plugin has to do per sample is the same.
+ */
+class FileInputSource : public InputSource, private Thread {
+public:
+    /** Files given directly, followed by every readable file under each directory (sorted). */
+    static std::vector<File> collect(const std::vector<std::string>& files,
+                                     const std::vector<std::string>& dirs)
+    {
+        AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::vector<File> out;
+        for (const auto& f : files)
+            out.push_back(File(f));
+
+        for (const auto& d : dirs) {
+            Array<File> found = File(d).findChildFiles(File::findFiles, true, formats.getWildcardForAllFormats());
+            std::vector<File> sorted(found.begin(), found.end());
+            std::sort(sorted.begin(), sorted.end(),
+                      [](const File& a, const File& b) { return a.getFullPathName() < b.getFullPathName(); });
+            out.insert(out.end(), sorted.begin(), sorted.end());
+        }
+        return out;
+    }
+
+    /** ringFrames is rounded up to hold at least four of the largest blocks. */
+    FileInputSource(std::vector<File> files, int channels, int maxBlockSize, int ringFrames = 1 << 18)
+        : Thread("plugperf decode"),
+          files_(std::move(files)),
+          channels_(jmax(1, channels)),
+          fifo_(nextPowerOfTwo(jmax(ringFrames, 4 * maxBlockSize))),
+          ring_(channels_, fifo_.getTotalSize())
+    {
+        formats_.registerBasicFormats();
+    }
+
+    ~FileInputSource() override { stopThread(2000); }
+
+    /** Check the files, start the decoder and wait until the ring is full. */
+    bool open(String& error)
+    {
+        int readable = 0;
+        for (const auto& f : files_) {
+            std::unique_ptr<AudioFormatReader> r(formats_.createReaderFor(f));
+            if (r == nullptr || r->lengthInSamples <= 0)
+                std::cerr << "WARNING: Skipping unreadable audio file: " << f.getFullPathName() << "\n";
+            else
+                ++readable;
+        }
+        if (readable == 0) {
+            error = "no readable audio files";
+            return false;
+        }
+
+        rewind();
+        return true;
+    }
+
+    void fill(AudioBuffer<float>& buf) override { readInto(buf); }
+    void fill(AudioBuffer<double>& buf) override { readInto(buf); }
+
+    /** Restart at the first file; blocks until the ring is full again. */
+    void rewind() override
+    {
+        stopThread(2000);
+        fifo_.reset();
+        fileIndex_ = 0;
+        reader_.reset();
+        readPos_ = 0;
+        startThread();
+
+        while (fifo_.getFreeSpace() > kChunkFrames && isThreadRunning())
+            Thread::sleep(1);
+    }
+
+    /** fill() calls that had to wait for the decoder (outside the timed region). */
+    uint64 underruns() const { return underruns_.load(); }
+    int filesOpened() const { return filesOpened_.load(); }
+    int filesMapped() const { return filesMapped_.load(); }
+
+private:
+    static constexpr int kChunkFrames = 4096;
+
+    template <typename Sample>
+    void readInto(AudioBuffer<Sample>& buf)
+    {
+        const int frames = buf.getNumSamples();
+        if (fifo_.getNumReady() < frames) {
+            ++underruns_;
+            while (fifo_.getNumReady() < frames) {
+                if (! isThreadRunning()) { buf.clear(); return; } // decoder gave up
+                Thread::sleep(1); // a SCHED_FIFO yield would never let the decoder in on a shared core
+            }
+        }
+
+        const auto scope = fifo_.read(frames);
+        copyOut(buf, 0, scope.startIndex1, scope.blockSize1);
+        copyOut(buf, scope.blockSize1, scope.startIndex2, scope.blockSize2);
+    }
+
+    template <typename Sample>
+    void copyOut(AudioBuffer<Sample>& buf, int dst, int src, int n) const
+    {
+        if (n <= 0) return;
+        for (int c = 0; c < buf.getNumChannels(); ++c) {
+            const float* in = ring_.getReadPointer(c % channels_) + src;
+            Sample* out = buf.getWritePointer(c) + dst;
+            for (int i = 0; i < n; ++i)
+                out[i] = (Sample) in[i];
+        }
+    }
+
+    std::unique_ptr<AudioFormatReader> createReader(const File& f)
+    {
+        if (f.hasFileExtension("wav")) {
+            WavAudioFormat wav;
+            std::unique_ptr<MemoryMappedAudioFormatReader> mapped(wav.createMemoryMappedReader(f));
+            if (mapped != nullptr && mapped->mapEntireFile()) {
+                ++filesMapped_;
+                return mapped;
+            }
+        }
+        return std::unique_ptr<AudioFormatReader>(formats_.createReaderFor(f));
+    }
+
+    /** Next readable file in list order, wrapping around; false if none is readable. */
+    bool openNext()
+    {
+        for (size_t tries = 0; tries < files_.size(); ++tries) {
+            const File& f = files_[fileIndex_++ % files_.size()];
+            reader_ = createReader(f);
+            readPos_ = 0;
+            if (reader_ != nullptr && reader_->lengthInSamples > 0) {
+                ++filesOpened_;
+                fileBuf_.setSize((int) reader_->numChannels, kChunkFrames, false, false, true);
+                return true;
+            }
+        }
+        reader_.reset();
+        return false;
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit()) {
+            if (fifo_.getFreeSpace() < kChunkFrames) {
+                wait(1);
+                continue;
+            }
+
+            if ((reader_ == nullptr || readPos_ >= reader_->lengthInSamples) && ! openNext())
+                return;
+
+            const int n = (int) jmin<int64>(kChunkFrames, reader_->lengthInSamples - readPos_);
+            reader_->read(&fileBuf_, 0, n, readPos_, true, true);
+            readPos_ += n;
+
+            const auto scope = fifo_.write(n);
+            copyIn(0, scope.startIndex1, scope.blockSize1);
+            copyIn(scope.blockSize1, scope.startIndex2, scope.blockSize2);
+        }
+    }
+
+    /** File channels are repeated over the benchmark channels (mono -> both sides). */
+    void copyIn(int src, int dst, int n)
+    {
+        if (n <= 0) return;
+        for (int c = 0; c < channels_; ++c)
+            ring_.copyFrom(c, dst, fileBuf_, c % fileBuf_.getNumChannels(), src, n);
+    }
+
+    std::vector<File> files_;
+    const int channels_;
+    AudioFormatManager formats_;
+
+    AbstractFifo fifo_;
+    AudioBuffer<float> ring_;
+
+    // Decoder-thread state
+    std::unique_ptr<AudioFormatReader> reader_;
+    AudioBuffer<float> fileBuf_;
+    size_t fileIndex_ = 0;
+    int64 readPos_ = 0;
+
+    std::atomic<uint64> underruns_ { 0 };
+    std::atomic<int> filesOpened_ { 0 }, filesMapped_ { 0 };
+};
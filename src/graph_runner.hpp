@@ -0,0 +1,409 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "session_graph.hpp"
+#include "work_stealing_deque.hpp"
+#include "rt_scheduling.hpp"
+#include "block_timer.hpp"
+#include "latency_histogram.hpp"
+#include "period_pacer.hpp"
+
+using namespace juce;
+
+struct GraphConfig {
+    // Creates one configured (layout, precision) but unprepared instance of a plugin path
+    std::function<std::unique_ptr<AudioPluginInstance>(const String&)> createInstance;
+    int blockSize = 0;
+    int channels = 0;
+    double sampleRate = 0.0;
+    int warmupPeriods = 0;
+    int timedPeriods = 0;
+    bool useDoublePrecision = false;
+    bool nonRealtime = false;
+    SchedPolicy schedPolicy = SchedPolicy::None; // None or Fifo, as in scaling mode
+    int rtPriority = 80;
+    TimerBackend timer = TimerBackend::Juce;
+    PacingMode pacing = PacingMode::None;
+    bool pinThreads = false;
+};
+
+struct GraphNodeStats {
+    double mean = 0.0, max = 0.0; // us per period, summing and all inserts
+    double workSharePct = 0.0;    // share of the total work per period
+    bool onCriticalPath = false;
+};
+
+struct GraphResult {
+    bool success = false;
+    String errorMessage;
+    int threads = 0;
+    std::vector<GraphNodeStats> nodes; // indexed like SessionGraph::nodes
+
+    double criticalPath = 0.0;      // us, longest dependency chain by mean node cost
+    double totalWork = 0.0;         // us, sum of mean node costs
+    double parallelism = 0.0;       // totalWork / criticalPath: best possible speed-up
+    double meanPeriod = 0.0, p99Period = 0.0, maxPeriod = 0.0; // us, whole graph
+    double budget = 0.0;            // us, block / sr
+    double periodUtilisationPct = 0.0; // mean period / budget
+    double workerUtilisationPct = 0.0; // totalWork / (threads * mean period)
+    uint64 deadlineMisses = 0;
+    double deadlineMissRate = 0.0;
+    std::string schedPolicy;
+};
+
+/**
+ * Runs a SessionGraph once per period on a pool of worker threads, the way a
+ * DAW renders parallel tracks.
+ *
+ * Each worker owns a Chase-Lev deque. At the start of a period every node's
+ * dependency counter is reset to its input count and the source nodes are
+ * queued on worker 0, the calling thread. Workers pop their own deque and
+ * steal from the others when it runs dry; finishing a node decrements its
+ * successors' counters, and whoever brings a counter to zero queues that
+ * successor locally, so a bus usually runs on the core that finished its last
+ * input. The period ends when every node has run.
+ *
+ * Plugins are instantiated and prepared on the calling (message) thread in
+ * prepare(); run() can then be repeated for different thread counts. The
+ * calling thread's pinning and SCHED_FIFO are undone when run() returns.
+ */
+class GraphRunner {
+public:
+    GraphRunner(const SessionGraph& graph, const GraphConfig& cfg)
+        : graph_(graph), cfg_(cfg), nodes_(graph.nodes.size()) {}
+
+    ~GraphRunner()
+    {
+        for (auto& node : nodes_)
+            for (auto& plugin : node.plugins)
+                plugin->releaseResources();
+    }
+
+    bool prepare(String& error)
+    {
+        for (size_t n = 0; n < nodes_.size(); ++n)
+        {
+            auto& node = nodes_[n];
+            const auto& desc = graph_.nodes[n];
+
+            for (int p = 0; p < desc.plugins.size(); ++p)
+            {
+                auto plugin = cfg_.createInstance(desc.plugins[p]);
+                if (plugin == nullptr)
+                {
+                    error = "could not load " + desc.plugins[p] + " for node '" + desc.name + "'";
+                    return false;
+                }
+
+                plugin->setNonRealtime(cfg_.nonRealtime);
+                plugin->prepareToPlay(cfg_.sampleRate, cfg_.blockSize);
+                node.plugins.push_back(std::move(plugin));
+            }
+
+            // Tracks get deterministic per-track input; buses sum into their buffer
+            Random rng(12345 + (int64) n);
+            auto setUp = [&](auto& buf, auto& input) {
+                buf.setSize(cfg_.channels, cfg_.blockSize);
+                buf.clear();
+                if (desc.kind != SessionGraph::Kind::Track)
+                    return;
+                input.setSize(cfg_.channels, cfg_.blockSize);
+                for (int c = 0; c < cfg_.channels; ++c)
+                    for (int i = 0; i < cfg_.blockSize; ++i)
+                        input.setSample(c, i, (rng.nextFloat() * 2.0f - 1.0f) * 0.1f);
+            };
+
+            if (cfg_.useDoublePrecision) setUp(node.doubleBuffer, node.doubleInput);
+            else setUp(node.floatBuffer, node.floatInput);
+        }
+
+        for (int n : graph_.order)
+            if (graph_.nodes[(size_t) n].inputs.empty())
+                sources_.push_back(n);
+
+        return true;
+    }
+
+    GraphResult run(int threads)
+    {
+        GraphResult result = cfg_.useDoublePrecision ? runImpl<double>(threads)
+                                                     : runImpl<float>(threads);
+        result.threads = threads;
+        return result;
+    }
+
+private:
+    struct NodeState {
+        std::vector<std::unique_ptr<AudioPluginInstance>> plugins;
+        AudioBuffer<float> floatBuffer, floatInput;
+        AudioBuffer<double> doubleBuffer, doubleInput;
+        MidiBuffer midi;
+
+        std::atomic<int> pending { 0 };
+        int64 sumTicks = 0, maxTicks = 0; // written by whichever worker ran the node
+
+        template <typename Sample>
+        AudioBuffer<Sample>& buffer()
+        {
+            if constexpr (std::is_same_v<Sample, double>) return doubleBuffer;
+            else return floatBuffer;
+        }
+
+        template <typename Sample>
+        AudioBuffer<Sample>& input()
+        {
+            if constexpr (std::is_same_v<Sample, double>) return doubleInput;
+            else return floatInput;
+        }
+    };
+
+    /** Helper workers 1..M-1; worker 0 is the calling thread. */
+    class Worker : public Thread {
+    public:
+        Worker(GraphRunner& owner, int index)
+            : Thread("PlugPerf Graph Worker " + String(index)), owner_(owner), index_(index) {}
+
+        ~Worker() override { stopThread(2000); }
+
+        void run() override
+        {
+            owner_.applyWorkerSetup(index_);
+
+            int64 seen = 0;
+            for (;;)
+            {
+                int64 epoch;
+                while ((epoch = owner_.epoch_.load(std::memory_order_acquire)) == seen)
+                {
+                    if (threadShouldExit()) return;
+                    std::this_thread::yield();
+                }
+
+                seen = epoch;
+                if (threadShouldExit()) return;
+
+                if (owner_.cfg_.useDoublePrecision) owner_.workUntilDone<double>(index_);
+                else owner_.workUntilDone<float>(index_);
+            }
+        }
+
+    private:
+        GraphRunner& owner_;
+        const int index_;
+    };
+
+    void applyWorkerSetup(int index)
+    {
+        if (cfg_.pinThreads)
+            RealtimeScheduling::pinToCpu(index);
+
+        String error;
+        if (cfg_.schedPolicy == SchedPolicy::Fifo && ! RealtimeScheduling::applyFifo(cfg_.rtPriority, error))
+            std::cerr << "WARNING: graph worker " << index << ": " << error << "\n";
+    }
+
+    /** Run one node: gather inputs, then the insert chain in place. */
+    template <typename Sample>
+    void execute(int n)
+    {
+        auto& node = nodes_[(size_t) n];
+        auto& buf = node.template buffer<Sample>();
+        const int64 t0 = timer_->start();
+
+        if (graph_.nodes[(size_t) n].kind == SessionGraph::Kind::Track)
+        {
+            auto& input = node.template input<Sample>();
+            for (int c = 0; c < buf.getNumChannels(); ++c)
+                buf.copyFrom(c, 0, input, c, 0, buf.getNumSamples());
+        }
+        else
+        {
+            buf.clear();
+            for (int in : graph_.nodes[(size_t) n].inputs)
+            {
+                auto& src = nodes_[(size_t) in].template buffer<Sample>();
+                for (int c = 0; c < buf.getNumChannels(); ++c)
+                    buf.addFrom(c, 0, src, c, 0, buf.getNumSamples());
+            }
+        }
+
+        for (auto& plugin : node.plugins)
+        {
+            node.midi.clear();
+            plugin->processBlock(buf, node.midi);
+        }
+
+        const int64 elapsed = timer_->stop() - t0;
+        if (recording_)
+        {
+            node.sumTicks += elapsed;
+            node.maxTicks = jmax(node.maxTicks, elapsed);
+        }
+    }
+
+    template <typename Sample>
+    void workUntilDone(int worker)
+    {
+        auto& own = *deques_[(size_t) worker];
+        const int count = (int) deques_.size();
+        int spins = 0;
+
+        while (remaining_.load(std::memory_order_acquire) > 0)
+        {
+            int task = own.pop();
+            for (int v = 1; task < 0 && v < count; ++v)
+                task = deques_[(size_t) ((worker + v) % count)]->steal();
+
+            if (task < 0)
+            {
+                RealtimeScheduling::spinOrYield(spins);
+                continue;
+            }
+
+            execute<Sample>(task);
+
+            for (int next : graph_.nodes[(size_t) task].outputs)
+                if (nodes_[(size_t) next].pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    own.push(next);
+
+            remaining_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    template <typename Sample>
+    GraphResult runImpl(int threads)
+    {
+        ScopedNoDenormals noDenormals;
+        GraphResult result;
+
+        const ScopedSchedulingState restoreScheduling;
+        applyWorkerSetup(0);
+        result.schedPolicy = RealtimeScheduling::describeCurrentThread();
+
+        const BlockTimer timer(cfg_.timer);
+        timer_ = &timer;
+        const double usPerTick = timer.ticksToMicros(1);
+        result.budget = (double) cfg_.blockSize * 1e6 / cfg_.sampleRate;
+        const int64 budgetTicks = (int64) (result.budget / usPerTick);
+
+        deques_.clear();
+        for (int w = 0; w < threads; ++w)
+            deques_.push_back(std::make_unique<WorkStealingDeque>((int) nodes_.size()));
+
+        for (auto& node : nodes_)
+            node.sumTicks = node.maxTicks = 0;
+        recording_ = false;
+        epoch_.store(0);
+        remaining_.store(0);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (int w = 1; w < threads; ++w)
+        {
+            workers.push_back(std::make_unique<Worker>(*this, w));
+            workers.back()->startThread(Thread::Priority::highest);
+        }
+
+        PeriodPacer pacer(cfg_.pacing, (double) cfg_.blockSize / cfg_.sampleRate);
+        LatencyHistogram hist;
+        pacer.start();
+
+        auto period = [&]() -> int64 {
+            if (cfg_.pacing != PacingMode::None)
+                pacer.waitForDeadline();
+
+            const int64 t0 = timer.start();
+            for (size_t n = 0; n < nodes_.size(); ++n)
+                nodes_[n].pending.store((int) graph_.nodes[n].inputs.size(), std::memory_order_relaxed);
+            remaining_.store((int) nodes_.size(), std::memory_order_release);
+            for (int n : sources_)
+                deques_[0]->push(n);
+            epoch_.fetch_add(1, std::memory_order_acq_rel);
+
+            workUntilDone<Sample>(0);
+            const int64 t1 = timer.stop();
+
+            if (cfg_.pacing != PacingMode::None)
+                pacer.finishPeriod();
+            return t1 - t0;
+        };
+
+        for (int i = 0; i < cfg_.warmupPeriods; ++i)
+            period();
+
+        recording_ = true;
+        for (int i = 0; i < cfg_.timedPeriods; ++i)
+        {
+            const int64 elapsed = period();
+            hist.record(elapsed);
+            if (elapsed > budgetTicks) ++result.deadlineMisses;
+        }
+
+        for (auto& w : workers)
+            w->signalThreadShouldExit();
+        epoch_.fetch_add(1, std::memory_order_acq_rel);
+        workers.clear();
+        timer_ = nullptr;
+
+        // Per-node cost and the critical path through mean costs
+        const double periods = (double) jmax(1, cfg_.timedPeriods);
+        std::vector<double> cost(nodes_.size());
+        for (size_t n = 0; n < nodes_.size(); ++n)
+        {
+            cost[n] = (double) nodes_[n].sumTicks / periods * usPerTick;
+            result.totalWork += cost[n];
+        }
+
+        result.nodes.resize(nodes_.size());
+        for (size_t n = 0; n < nodes_.size(); ++n)
+        {
+            result.nodes[n].mean = cost[n];
+            result.nodes[n].max = (double) nodes_[n].maxTicks * usPerTick;
+            result.nodes[n].workSharePct = result.totalWork > 0.0 ? cost[n] / result.totalWork * 100.0 : 0.0;
+        }
+
+        for (int n : graph_.criticalPath(cost, result.criticalPath))
+            result.nodes[(size_t) n].onCriticalPath = true;
+
+        result.parallelism = result.criticalPath > 0.0 ? result.totalWork / result.criticalPath : 0.0;
+        result.meanPeriod = hist.mean() * usPerTick;
+        result.p99Period = hist.valueAtQuantile(0.99) * usPerTick;
+        result.maxPeriod = (double) hist.max() * usPerTick;
+        result.periodUtilisationPct = result.budget > 0.0 ? result.meanPeriod / result.budget * 100.0 : 0.0;
+        result.workerUtilisationPct = result.meanPeriod > 0.0
+                                        ? result.totalWork / ((double) threads * result.meanPeriod) * 100.0 : 0.0;
+        result.deadlineMissRate = cfg_.timedPeriods > 0
+                                    ? (double) result.deadlineMisses / (double) cfg_.timedPeriods : 0.0;
+
+        if (result.deadlineMisses > 0)
+        {
+            std::cerr << "WARNING [graph threads=" << threads << ", buffer=" << cfg_.blockSize << "]: "
+                      << result.deadlineMisses << " of " << cfg_.timedPeriods
+                      << " periods missed the " << result.budget << "us deadline (max="
+                      << result.maxPeriod << "us)\n";
+        }
+
+        result.success = true;
+        return result;
+    }
+
+    const SessionGraph& graph_;
+    GraphConfig cfg_;
+    std::vector<NodeState> nodes_;
+    std::vector<int> sources_;
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques_;
+    const BlockTimer* timer_ = nullptr;
+    bool recording_ = false;
+
+    std::atomic<int64> epoch_ { 0 };
+    std::atomic<int> remaining_ { 0 };
+};
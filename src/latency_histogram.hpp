@@ -0,0 +1,156 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_MSC_VER)
+ #include <intrin.h>
+#endif
+
+using namespace juce;
+
+/**
+ * Fixed-memory log-linear histogram (HDR style) for timer ticks.
+ *
+ * Values below 2048 are counted exactly. Above that, every power-of-two range
+ * is split into 1024 linear sub-buckets, so any recorded value is known to
+ * within 0.1%. Memory is fixed (~310 KB) regardless of how many samples are
+ * recorded, min/max are exact, and mean/variance are tracked with Welford's
+ * method. Two histograms merge losslessly, e.g. across passes or threads.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int subBucketBits = 11;
+    static constexpr int64 subBucketCount = (int64) 1 << subBucketBits;
+    static constexpr int64 subBucketHalf = subBucketCount / 2;
+    static constexpr int maxValueBits = 48; // larger values share the top bucket
+
+    LatencyHistogram() : counts_(numBuckets(), 0) {}
+
+    void reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        count_ = 0;
+        min_ = std::numeric_limits<int64>::max();
+        max_ = 0;
+        mean_ = 0.0;
+        m2_ = 0.0;
+    }
+
+    inline void record(int64 value) {
+        if (value < 0) value = 0;
+
+        ++counts_[indexFor(value)];
+        ++count_;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+
+        const double delta = (double) value - mean_;
+        mean_ += delta / (double) count_;
+        m2_ += delta * ((double) value - mean_);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        if (other.count_ == 0) return;
+
+        for (size_t i = 0; i < counts_.size(); ++i)
+            counts_[i] += other.counts_[i];
+
+        // Chan et al. parallel combination of mean and M2
+        const double n1 = (double) count_;
+        const double n2 = (double) other.count_;
+        const double delta = other.mean_ - mean_;
+        const double n = n1 + n2;
+        mean_ += delta * n2 / n;
+        m2_ += other.m2_ + delta * delta * n1 * n2 / n;
+
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64 count() const { return count_; }
+    int64 min() const { return count_ > 0 ? min_ : 0; }
+    int64 max() const { return max_; }
+    double mean() const { return mean_; }
+
+    /** Population standard deviation, matching the previous sort-based stats. */
+    double stdDev() const { return count_ > 0 ? std::sqrt(m2_ / (double) count_) : 0.0; }
+
+    /**
+     * Value at quantile q (0..1), using the same rank as the old sorted-vector
+     * pick: the element at floor(q * (n - 1)). Reports the bucket midpoint,
+     * clamped to the exact min/max.
+     */
+    double valueAtQuantile(double q) const {
+        if (count_ == 0) return 0.0;
+        if (q <= 0.0) return (double) min();
+        if (q >= 1.0) return (double) max_;
+
+        const uint64 rank = (uint64) std::floor(q * (double) (count_ - 1));
+        uint64 seen = 0;
+
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen > rank) {
+                const double mid = (double) lowestValueAt(i) + (double) (bucketWidthAt(i) - 1) / 2.0;
+                return jlimit((double) min_, (double) max_, mid);
+            }
+        }
+
+        return (double) max_;
+    }
+
+private:
+    static size_t numBuckets() {
+        return (size_t) (subBucketCount + (maxValueBits - subBucketBits) * subBucketHalf);
+    }
+
+    static inline size_t indexFor(int64 value) {
+        if (value < subBucketCount)
+            return (size_t) value;
+
+        if (value >= ((int64) 1 << maxValueBits))
+            return numBuckets() - 1;
+
+        const int msb = 63 - countLeadingZeros((uint64) value);
+        const int shift = msb - (subBucketBits - 1);
+        const int64 top = value >> shift; // in [subBucketHalf, subBucketCount)
+        return (size_t) (subBucketCount + (int64) (shift - 1) * subBucketHalf + (top - subBucketHalf));
+    }
+
+    static int64 lowestValueAt(size_t index) {
+        if ((int64) index < subBucketCount)
+            return (int64) index;
+
+        const int64 k = (int64) index - subBucketCount;
+        const int shift = (int) (k / subBucketHalf) + 1;
+        return (k % subBucketHalf + subBucketHalf) << shift;
+    }
+
+    static int64 bucketWidthAt(size_t index) {
+        if ((int64) index < subBucketCount)
+            return 1;
+
+        const int64 k = (int64) index - subBucketCount;
+        return (int64) 1 << ((int) (k / subBucketHalf) + 1);
+    }
+
+    static inline int countLeadingZeros(uint64 v) {
+       #if defined(_MSC_VER)
+        unsigned long idx = 0;
+        _BitScanReverse64(&idx, v);
+        return 63 - (int) idx;
+       #else
+        return __builtin_clzll(v);
+       #endif
+    }
+
+    std::vector<uint64> counts_;
+    uint64 count_ = 0;
+    int64 min_ = std::numeric_limits<int64>::max();
+    int64 max_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+};
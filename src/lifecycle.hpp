@@ -0,0 +1,156 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+#include "plugin_host.hpp"
+
+using namespace juce;
+
+/** Wall-clock laps for one-off phases (scan, instantiate, prepare, ...). */
+struct PhaseTimer {
+    int64 t0 = Time::getHighResolutionTicks();
+
+    /** Milliseconds since construction or the previous lap. */
+    double lapMs() {
+        const int64 now = Time::getHighResolutionTicks();
+        const double ms = Time::highResolutionTicksToSeconds(now - t0) * 1000.0;
+        t0 = now;
+        return ms;
+    }
+};
+
+/**
+ * Time of every phase of bringing a plugin up and tearing it down again.
+ * Phases that did not run stay at -1.
+ */
+struct LifecycleRecord {
+    double scanMs = -1.0;         // findAllTypesForFile (includes the first dlopen)
+    double instantiateMs = -1.0;  // createPluginInstance
+    double layoutMs = -1.0;       // channel layout + processing precision
+    double presetMs = -1.0;       // preset parameters applied
+    double prepareMs = -1.0;      // prepareToPlay
+    double firstBlockUs = -1.0;   // first processBlock after prepareToPlay
+    double steadyBlockUs = -1.0;  // mean of the blocks that follow it
+    double releaseMs = -1.0;      // releaseResources
+    double destroyMs = -1.0;      // instance destructor (module unload when it was the last one)
+
+    /** Load-to-first-audio time: everything up to and including the first block. */
+    double loadMs() const {
+        double total = 0.0;
+        for (double ms : { scanMs, instantiateMs, layoutMs, presetMs, prepareMs })
+            if (ms > 0.0) total += ms;
+        return total + jmax(0.0, firstBlockUs) / 1000.0;
+    }
+};
+
+struct LifecycleConfig {
+    String pluginPath;
+    int channels = 2;
+    bool useDoublePrecision = false;
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    bool nonRealtime = false;
+    int steadyBlocks = 16;                                  // blocks after the first one
+    std::function<void (AudioPluginInstance&)> applyPreset; // optional
+};
+
+/**
+ * Full load/unload cycles of one plugin, each phase timed on its own. The
+ * first cycle in a process pays for reading the binary, relocations and
+ * static initialisers; later cycles show what a warm page cache and an
+ * already-resolved loader leave of that. Must run on the message thread.
+ */
+class LifecycleProbe {
+public:
+    static bool runCycle(AudioPluginFormatManager& fm, AudioPluginFormat& format,
+                         const LifecycleConfig& cfg, LifecycleRecord& rec, String& error)
+    {
+        rec = {};
+        PhaseTimer phase;
+
+        OwnedArray<PluginDescription> found;
+        format.findAllTypesForFile(found, cfg.pluginPath);
+        rec.scanMs = phase.lapMs();
+        if (found.isEmpty()) {
+            error = "No VST3 plugins found in: " + cfg.pluginPath;
+            return false;
+        }
+
+        String err;
+        std::unique_ptr<AudioPluginInstance> instance(fm.createPluginInstance(*found[0], 0, 0, err));
+        rec.instantiateMs = phase.lapMs();
+        if (instance == nullptr) {
+            error = "CreatePluginInstance failed: " + err;
+            return false;
+        }
+
+        int configured = cfg.channels;
+        const bool layoutOk = PluginHost::configureChannelLayout(*instance, cfg.channels, configured);
+        const bool useDouble = cfg.useDoublePrecision && instance->supportsDoublePrecisionProcessing();
+        instance->setProcessingPrecision(useDouble ? AudioProcessor::doublePrecision
+                                                   : AudioProcessor::singlePrecision);
+        rec.layoutMs = phase.lapMs();
+        if (! layoutOk) {
+            error = "Unable to configure plugin for " + String(cfg.channels) + " channels";
+            return false;
+        }
+
+        if (cfg.applyPreset) {
+            phase.lapMs();
+            cfg.applyPreset(*instance);
+            rec.presetMs = phase.lapMs();
+        }
+
+        phase.lapMs();
+        instance->setNonRealtime(cfg.nonRealtime);
+        instance->prepareToPlay(cfg.sampleRate, cfg.blockSize);
+        rec.prepareMs = phase.lapMs();
+
+        if (useDouble)
+            timeBlocks<double>(*instance, configured, cfg, rec);
+        else
+            timeBlocks<float>(*instance, configured, cfg, rec);
+
+        phase.lapMs();
+        instance->releaseResources();
+        rec.releaseMs = phase.lapMs();
+
+        instance.reset();
+        rec.destroyMs = phase.lapMs();
+        return true;
+    }
+
+    /** The first block after prepareToPlay, then the steady blocks after it. */
+    template <typename Sample>
+    static void timeBlocks(AudioPluginInstance& plug, int channels,
+                           const LifecycleConfig& cfg, LifecycleRecord& rec)
+    {
+        ScopedNoDenormals noDenormals;
+
+        AudioBuffer<Sample> buf(channels, cfg.blockSize);
+        MidiBuffer midi;
+
+        // Same deterministic input as the benchmark passes
+        Random rng(12345);
+        for (int c = 0; c < buf.getNumChannels(); ++c)
+            for (int n = 0; n < buf.getNumSamples(); ++n)
+                buf.setSample(c, n, (Sample)((rng.nextFloat() * 2.0f - 1.0f) * 0.1f));
+
+        PhaseTimer phase;
+        plug.processBlock(buf, midi);
+        rec.firstBlockUs = phase.lapMs() * 1000.0;
+
+        if (cfg.steadyBlocks <= 0)
+            return;
+
+        for (int i = 0; i < cfg.steadyBlocks; ++i) {
+            midi.clear();
+            plug.processBlock(buf, midi);
+        }
+        rec.steadyBlockUs = phase.lapMs() * 1000.0 / cfg.steadyBlocks;
+    }
+};
@@ -8,87 +8,480 @@
 #include <string>
 #include <thread>
 #include <atomic>
+#include <map>
 
 #include "argparse.hpp"
 #include "csv.hpp"
 #include "benchmark_thread.hpp"
+#include "block_timer.hpp"
 #include "system_info.hpp"
+#include "plugin_host.hpp"
+#include "scaling_benchmark.hpp"
+#include "polyphony_search.hpp"
+#include "block_stream.hpp"
+#include "graph_runner.hpp"
+#include "chain_benchmark.hpp"
+#include "lifecycle.hpp"
+#include "memory_footprint.hpp"
+#include "file_input.hpp"
 #include "storybored_presets.hpp"
+#include "phase_report.hpp"
 
 using namespace juce;
 
-static bool configureChannelLayout(AudioPluginInstance& proc,
-                                   int requestedChannels,
-                                   int& configuredChannels)
+// Measurement logic moved to benchmark_thread.hpp for real-time thread execution
+
+/**
+ * --pin-threads gives worker i its own CPU; more workers than allowed CPUs
+ * would put two of them on one CPU, where a SCHED_FIFO pair can starve.
+ */
+static bool checkPinnedThreadCounts(const std::vector<int>& counts, const char* flag)
 {
-    if (requestedChannels <= 0)
-        return false;
+    const int cpus = RealtimeScheduling::allowedCpuCount();
+    for (int t : counts) {
+        if (t > cpus) {
+            std::cerr << flag << " " << t << " exceeds the " << cpus
+                      << " CPUs this process may run on (--pin-threads needs one per worker)\n";
+            return false;
+        }
+    }
+    return true;
+}
 
-    if (requestedChannels != 1 && requestedChannels != 2)
-        return false;
+/**
+ * --session mode: render a whole track/bus graph per period on a worker pool
+ * and write per-node and per-period rows (CsvSink::graphHeader()).
+ */
+static int runSessionGraph(const Args& args, AudioPluginFormatManager& fm, AudioPluginFormat& vst3Format)
+{
+    SessionGraph graph;
+    String error;
+    if (! SessionGraph::load(File(args.sessionPath), graph, error)) {
+        std::cerr << "Invalid session: " << error << "\n";
+        return 2;
+    }
 
-    const int inputBusCount  = proc.getBusCount(true);
-    const int outputBusCount = proc.getBusCount(false);
-    const auto desiredSet = (requestedChannels == 1)
-                                ? AudioChannelSet::mono()
-                                : AudioChannelSet::stereo();
+    const bool useDouble = args.bitDepth == "64f";
+    const std::string bitDepthLabel = useDouble ? "64f" : "32f";
 
-    bool layoutChanged = false;
-    auto layout = proc.getBusesLayout();
+    SchedPolicy schedPolicy = SchedPolicy::None;
+    RealtimeScheduling::parsePolicy(args.sched, schedPolicy);
+    if (schedPolicy == SchedPolicy::Deadline) {
+        std::cerr << "WARNING: --sched deadline is not supported with --session; using fifo.\n";
+        schedPolicy = SchedPolicy::Fifo;
+    }
 
-    if (outputBusCount > 0)
-    {
-        if (layout.outputBuses.getReference(0) != desiredSet)
-        {
-            layout.outputBuses.getReference(0) = desiredSet;
-            layoutChanged = true;
+    PacingMode pacing = PacingMode::None;
+    PeriodPacer::parseMode(args.paced, pacing);
+
+    TimerBackend requestedTimer = TimerBackend::Juce;
+    BlockTimer::parseBackend(args.timer, requestedTimer);
+    const BlockTimer blockTimer(requestedTimer);
+
+    // Scan each plugin file once, however many nodes use it
+    std::map<std::string, PluginDescription> scanned;
+    auto createInstance = [&](const String& path) -> std::unique_ptr<AudioPluginInstance> {
+        auto it = scanned.find(path.toStdString());
+        if (it == scanned.end()) {
+            OwnedArray<PluginDescription> found;
+            vst3Format.findAllTypesForFile(found, path);
+            if (found.isEmpty()) {
+                std::cerr << "No VST3 plugins found in: " << path << "\n";
+                return nullptr;
+            }
+            it = scanned.emplace(path.toStdString(), *found[0]).first;
+        }
+
+        auto inst = PluginHost::createConfiguredInstance(fm, it->second, args.channels, useDouble);
+        if (inst != nullptr && useDouble && ! inst->supportsDoublePrecisionProcessing()) {
+            std::cerr << "Plugin does not support double precision: " << path << "\n";
+            return nullptr;
         }
+        return inst;
+    };
+
+    std::vector<int> threadCounts = args.graphThreads;
+    if (threadCounts.empty())
+        threadCounts.push_back(jmax(1, jmin(SystemStats::getNumPhysicalCpus(),
+                                            RealtimeScheduling::allowedCpuCount())));
+    if (args.pinThreads && ! checkPinnedThreadCounts(threadCounts, "--graph-threads"))
+        return 2;
+
+    CsvSink sink;
+    if (!sink.open(args.outCsv)) {
+        std::cerr << "Failed to open CSV for writing: " << args.outCsv << "\n";
+        return 3;
     }
+    sink.graphHeader();
+
+    SystemInfo sysInfo = SystemInfo::collect();
+    const std::string sessionName = File(args.sessionPath).getFileNameWithoutExtension().toStdString();
 
-    if (inputBusCount > 0)
+    for (int block : args.buffers)
     {
-        if (layout.inputBuses.getReference(0) != desiredSet)
+        if (block <= 0) continue;
+
+        GraphConfig gc;
+        gc.createInstance = createInstance;
+        gc.blockSize = block;
+        gc.channels = args.channels;
+        gc.sampleRate = args.sampleRate;
+        gc.warmupPeriods = args.warmup;
+        gc.timedPeriods = args.iterations;
+        gc.useDoublePrecision = useDouble;
+        gc.nonRealtime = args.nonRealtime;
+        gc.schedPolicy = schedPolicy;
+        gc.rtPriority = args.rtPriority;
+        gc.timer = blockTimer.backend();
+        gc.pacing = pacing;
+        gc.pinThreads = args.pinThreads;
+
+        GraphRunner runner(graph, gc);
+        if (! runner.prepare(error)) {
+            std::cerr << "Session setup failed for buffer size " << block << ": " << error << "\n";
+            return 2;
+        }
+
+        for (int threads : threadCounts)
         {
-            layout.inputBuses.getReference(0) = desiredSet;
-            layoutChanged = true;
+            const GraphResult r = runner.run(threads);
+
+            // Column order must match CsvSink::graphHeader(); node rows leave the
+            // period columns empty and the period row leaves the node columns empty
+            auto rowFor = [&](const std::string& node, const std::string& kind,
+                              std::vector<std::string> nodeCols, std::vector<std::string> periodCols) {
+                std::vector<std::string> row {
+                    sessionName, std::to_string(args.sampleRate), std::to_string(args.channels), bitDepthLabel,
+                    std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
+                    std::to_string(threads), node, kind
+                };
+                row.insert(row.end(), nodeCols.begin(), nodeCols.end());
+                row.insert(row.end(), periodCols.begin(), periodCols.end());
+                row.insert(row.end(), {
+                    r.schedPolicy, blockTimer.name(),
+                    sysInfo.cpuModel.toStdString(),
+                    std::to_string(sysInfo.numPhysicalCores),
+                    std::to_string(sysInfo.cpuSpeedMHz),
+                    std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+                    sysInfo.osName.toStdString()
+                });
+                return row;
+            };
+
+            for (size_t n = 0; n < graph.nodes.size(); ++n)
+            {
+                const auto& desc = graph.nodes[n];
+                const auto& ns = r.nodes[n];
+                sink.row(rowFor(desc.name.toStdString(), SessionGraph::kindName(desc.kind),
+                                { std::to_string(desc.plugins.size()), std::to_string(desc.inputs.size()),
+                                  std::to_string(ns.mean), std::to_string(ns.max),
+                                  std::to_string(ns.workSharePct), ns.onCriticalPath ? "1" : "0" },
+                                std::vector<std::string>(12)));
+            }
+
+            sink.row(rowFor("(period)", "period", std::vector<std::string>(6),
+                            { std::to_string(r.criticalPath), std::to_string(r.totalWork),
+                              std::to_string(r.parallelism), std::to_string(r.meanPeriod),
+                              std::to_string(r.p99Period), std::to_string(r.maxPeriod),
+                              std::to_string(r.budget), std::to_string(r.periodUtilisationPct),
+                              std::to_string(r.workerUtilisationPct), std::to_string(r.deadlineMisses),
+                              std::to_string(r.deadlineMissRate), std::to_string(graph.nodes.size()) }));
         }
     }
 
-    if (layoutChanged && ! proc.setBusesLayout(layout))
-        return false;
+    return 0;
+}
 
-    const int actualInputs  = inputBusCount  > 0 ? proc.getChannelCountOfBus(true, 0)  : 0;
-    const int actualOutputs = outputBusCount > 0 ? proc.getChannelCountOfBus(false, 0) : 0;
+/**
+ * Insert-chain mode (several --plugin, or --chain): measure each plugin alone
+ * and inside one serial chain, and write CsvSink::chainHeader() rows.
+ */
+static int runPluginChain(const Args& args, const std::vector<std::string>& paths,
+                          AudioPluginFormatManager& fm, AudioPluginFormat& vst3Format)
+{
+    const bool wantsDouble = args.bitDepth == "64f";
+    std::vector<std::unique_ptr<AudioPluginInstance>> instances;
+    std::vector<std::string> names;
 
-    if (outputBusCount > 0)
+    for (const auto& path : paths)
     {
-        if (actualOutputs != requestedChannels)
-            return false;
+        OwnedArray<PluginDescription> found;
+        vst3Format.findAllTypesForFile(found, path);
+        if (found.isEmpty()) {
+            std::cerr << "No VST3 plugins found in: " << path << "\n";
+            return 2;
+        }
 
-        configuredChannels = actualOutputs;
+        auto inst = PluginHost::createConfiguredInstance(fm, *found[0], args.channels, wantsDouble);
+        if (inst == nullptr)
+            return 2;
+
+        names.push_back(inst->getName().toStdString());
+        instances.push_back(std::move(inst));
     }
-    else
-    {
-        configuredChannels = requestedChannels;
+
+    // The chain shares one buffer, so it runs in double only if every insert can
+    bool useDouble = wantsDouble;
+    for (auto& inst : instances)
+        useDouble = useDouble && inst->supportsDoublePrecisionProcessing();
+    if (wantsDouble && !useDouble) {
+        std::cerr << "WARNING: Not every plugin in the chain supports double precision processing; "
+                  << "falling back to single precision measurements.\n";
+        for (auto& inst : instances)
+            inst->setProcessingPrecision(AudioProcessor::singlePrecision);
     }
+    const std::string bitDepthLabel = useDouble ? "64f" : "32f";
 
-    if (inputBusCount > 0 && actualInputs != 0 && actualInputs != requestedChannels)
-        return false;
+    if (!args.presetJson.empty())
+        std::cerr << "WARNING: --preset-json is ignored in chain mode.\n";
 
-    return true;
+    // The chain runs on the calling thread, FIFO only while it processes; a
+    // deadline reservation would also throttle prepareToPlay, so FIFO stands in for it
+    SchedPolicy schedPolicy = SchedPolicy::None;
+    RealtimeScheduling::parsePolicy(args.sched, schedPolicy);
+    if (schedPolicy == SchedPolicy::Deadline)
+        std::cerr << "WARNING: --sched deadline is not supported in chain mode; using fifo.\n";
+
+    TimerBackend requestedTimer = TimerBackend::Juce;
+    BlockTimer::parseBackend(args.timer, requestedTimer);
+    const BlockTimer blockTimer(requestedTimer);
+
+    CsvSink sink;
+    if (!sink.open(args.outCsv)) {
+        std::cerr << "Failed to open CSV for writing: " << args.outCsv << "\n";
+        return 3;
+    }
+    sink.chainHeader();
+
+    SystemInfo sysInfo = SystemInfo::collect();
+    const std::string chainName = args.chainFile.empty()
+                                    ? std::string("cli")
+                                    : File(args.chainFile).getFileNameWithoutExtension().toStdString();
+
+    for (int block : args.buffers)
+    {
+        if (block <= 0) continue;
+
+        ChainConfig cc;
+        for (auto& inst : instances)
+            cc.plugins.push_back(inst.get());
+        cc.blockSize = block;
+        cc.channels = args.channels;
+        cc.sampleRate = args.sampleRate;
+        cc.warmupIterations = args.warmup;
+        cc.timedIterations = args.iterations;
+        cc.useDoublePrecision = useDouble;
+        cc.nonRealtime = args.nonRealtime;
+        cc.timer = blockTimer.backend();
+        cc.fifo = schedPolicy != SchedPolicy::None;
+        cc.rtPriority = args.rtPriority;
+
+        const ChainResult r = ChainBenchmark::measure(cc);
+
+        // Column order must match CsvSink::chainHeader()
+        auto rowFor = [&](const std::string& position, const std::string& name, const std::string& path,
+                          double isoMean, const std::string& isoP99,
+                          double mean, double p99, double mx, const std::string& misses, const std::string& missRate) {
+            return std::vector<std::string> {
+                chainName, std::to_string(args.sampleRate), std::to_string(args.channels), bitDepthLabel,
+                std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
+                position, name, path,
+                std::to_string(isoMean), isoP99,
+                std::to_string(mean), std::to_string(p99), std::to_string(mx),
+                std::to_string(isoMean > 0.0 ? mean / isoMean : 0.0),
+                std::to_string(r.budget), misses, missRate,
+                r.schedPolicy, blockTimer.name(),
+                sysInfo.cpuModel.toStdString(),
+                std::to_string(sysInfo.numPhysicalCores),
+                std::to_string(sysInfo.cpuSpeedMHz),
+                std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+                sysInfo.osName.toStdString()
+            };
+        };
+
+        for (size_t p = 0; p < instances.size(); ++p)
+        {
+            const auto& slot = r.slots[p];
+            sink.row(rowFor(std::to_string(p + 1), names[p], paths[p],
+                            slot.isolatedMean, std::to_string(slot.isolatedP99),
+                            slot.chainMean, slot.chainP99, slot.chainMax, "", ""));
+        }
+
+        sink.row(rowFor("total", "(chain)", "", r.isolatedSum, "",
+                        r.chainMean, r.chainP99, r.chainMax,
+                        std::to_string(r.deadlineMisses), std::to_string(r.deadlineMissRate)));
+    }
+
+    return 0;
 }
 
-// Measurement logic moved to benchmark_thread.hpp for real-time thread execution
+/**
+ * --lifecycle mode: N full load/unload cycles of one plugin, one
+ * CsvSink::lifecycleHeader() row per cycle. Cycle 0 is the cold one.
+ */
+static int runLifecycleCycles(const Args& args, AudioPluginFormatManager& fm, AudioPluginFormat& vst3Format)
+{
+    int block = 0;
+    for (int b : args.buffers)
+        if (b > 0) { block = b; break; }
+    if (block <= 0) {
+        std::cerr << "--lifecycle needs a positive buffer size\n";
+        return 2;
+    }
+
+    // Parsing the preset file is host work; only applying it is timed
+    StoryBoredPresetLoader::PresetData presetData;
+    if (!args.presetJson.empty()) {
+        presetData = StoryBoredPresetLoader::loadPreset(String(args.presetJson));
+        if (!presetData.isValid)
+            std::cerr << "WARNING: Failed to load preset: " << args.presetJson << "\n";
+    }
+
+    LifecycleConfig lc;
+    lc.pluginPath = args.pluginPath;
+    lc.channels = args.channels;
+    lc.useDoublePrecision = args.bitDepth == "64f";
+    lc.sampleRate = args.sampleRate;
+    lc.blockSize = block;
+    lc.nonRealtime = args.nonRealtime;
+    lc.steadyBlocks = jmax(1, args.warmup);
+    if (presetData.isValid)
+        lc.applyPreset = [&](AudioPluginInstance& p) { StoryBoredPresetLoader::applyPresetToPlugin(p, presetData, false); };
 
-static void printInstantiationError(const String& err, const String& path)
+    CsvSink sink;
+    if (!sink.open(args.outCsv)) {
+        std::cerr << "Failed to open CSV for writing: " << args.outCsv << "\n";
+        return 3;
+    }
+    sink.lifecycleHeader();
+
+    SystemInfo sysInfo = SystemInfo::collect();
+    auto ms = [](double v) { return v >= 0.0 ? std::to_string(v) : std::string(); };
+
+    for (int cycle = 0; cycle < args.lifecycleCycles; ++cycle)
+    {
+        LifecycleRecord rec;
+        String error;
+        if (! LifecycleProbe::runCycle(fm, vst3Format, lc, rec, error)) {
+            std::cerr << "Lifecycle cycle " << cycle << " failed: " << error << "\n";
+            return 2;
+        }
+
+        std::cerr << "LIFECYCLE [cycle=" << cycle << "]: load=" << rec.loadMs() << "ms first_block="
+                  << rec.firstBlockUs << "us destroy=" << rec.destroyMs << "ms\n";
+
+        // Column order must match CsvSink::lifecycleHeader()
+        sink.row({
+            File(args.pluginPath).getFileNameWithoutExtension().toStdString(), args.pluginPath, "VST3",
+            std::to_string(args.sampleRate), std::to_string(args.channels),
+            lc.useDoublePrecision ? "64f" : "32f", std::to_string(block), std::to_string(cycle),
+            ms(rec.scanMs), ms(rec.instantiateMs), ms(rec.layoutMs), ms(rec.presetMs), ms(rec.prepareMs),
+            ms(rec.firstBlockUs), ms(rec.steadyBlockUs),
+            std::to_string(rec.steadyBlockUs > 0.0 ? rec.firstBlockUs / rec.steadyBlockUs : 0.0),
+            std::to_string(rec.loadMs()), ms(rec.releaseMs), ms(rec.destroyMs),
+            sysInfo.cpuModel.toStdString(),
+            std::to_string(sysInfo.numPhysicalCores),
+            std::to_string(sysInfo.cpuSpeedMHz),
+            std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+            sysInfo.osName.toStdString()
+        });
+    }
+
+    return 0;
+}
+
+/**
+ * --memory mode: sample RSS/PSS/USS through loading, preparing, extra
+ * instances and leak cycles, one CsvSink::memoryHeader() row per stage.
+ */
+static int runMemoryProfile(const Args& args, AudioPluginFormatManager& fm, AudioPluginFormat& vst3Format)
 {
-    std::cerr << "CreatePluginInstance failed for \n  "
-              << path << "\nReason: " << err << "\n";
+    StoryBoredPresetLoader::PresetData presetData;
+    if (!args.presetJson.empty()) {
+        presetData = StoryBoredPresetLoader::loadPreset(String(args.presetJson));
+        if (!presetData.isValid)
+            std::cerr << "WARNING: Failed to load preset: " << args.presetJson << "\n";
+    }
+
+    MemoryConfig mc;
+    mc.pluginPath = args.pluginPath;
+    mc.channels = args.channels;
+    mc.useDoublePrecision = args.bitDepth == "64f";
+    mc.sampleRate = args.sampleRate;
+    mc.blockSizes = args.buffers;
+    mc.nonRealtime = args.nonRealtime;
+    mc.blocksAfterPrepare = jmax(1, args.warmup);
+    mc.extraInstances = args.memoryInstances;
+    mc.cycles = args.memoryCycles;
+    if (presetData.isValid)
+        mc.applyPreset = [&](AudioPluginInstance& p) { StoryBoredPresetLoader::applyPresetToPlugin(p, presetData, false); };
+
+    CsvSink sink;
+    if (!sink.open(args.outCsv)) {
+        std::cerr << "Failed to open CSV for writing: " << args.outCsv << "\n";
+        return 3;
+    }
+    sink.memoryHeader();
+
+    std::vector<MemoryStage> stages;
+    String error;
+    MemoryProfiler profiler(fm, vst3Format, mc);
+    if (! profiler.run(stages, error)) {
+        std::cerr << "Memory profile failed: " << error << "\n";
+        return 2;
+    }
+
+    SystemInfo sysInfo = SystemInfo::collect();
+    const std::string pluginName = File(args.pluginPath).getFileNameWithoutExtension().toStdString();
+    auto kb = [](int64 v, bool present) { return present ? std::to_string(v) : std::string(); };
+
+    for (const auto& st : stages)
+    {
+        // A page per cycle that never comes back is a leak, not allocator noise
+        if (st.stage.find("_growth") != std::string::npos && st.delta.ussKb >= 4) {
+            std::cerr << "WARNING: " << st.stage << ": private memory grows by " << st.delta.ussKb
+                      << " KiB per cycle (possible leak)\n";
+        }
+
+        const bool abs = st.absolute.valid();
+
+        // Column order must match CsvSink::memoryHeader()
+        sink.row({
+            pluginName, args.pluginPath, "VST3",
+            std::to_string(args.sampleRate), std::to_string(args.channels), args.bitDepth,
+            st.stage, st.blockSize > 0 ? std::to_string(st.blockSize) : std::string(),
+            std::to_string(st.instances), st.cycle >= 0 ? std::to_string(st.cycle) : std::string(),
+            kb(st.absolute.rssKb, abs), kb(st.absolute.pssKb, abs), kb(st.absolute.ussKb, abs),
+            std::to_string(st.delta.rssKb), std::to_string(st.delta.pssKb), std::to_string(st.delta.ussKb),
+            sysInfo.cpuModel.toStdString(),
+            std::to_string(sysInfo.numPhysicalCores),
+            std::to_string(sysInfo.cpuSpeedMHz),
+            std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+            sysInfo.osName.toStdString()
+        });
+    }
+
+    return 0;
 }
 
 int main (int argc, char** argv)
 {
     Args args; if (!parseArgs(argc, argv, args)) return argc <= 1 ? 0 : 1;
+    PhaseReport::open(args.phaseFd);
+
+    // --channels entries may name layouts (5.1, 7.1.4, ambi3); modes that take
+    // a plain count negotiate from the first entry's channel count
+    std::vector<AudioChannelSet> channelLayouts;
+    for (const auto& spec : args.channelLayouts) {
+        AudioChannelSet set;
+        if (!PluginHost::parseChannelLayout(String(spec), set)) {
+            std::cerr << "Unknown channel layout: " << spec
+                      << " (use a count, lcr, quad, 5.0 .. 9.1.6 or ambi1 .. ambi7)\n";
+            return 1;
+        }
+        channelLayouts.push_back(set);
+    }
+    args.channels = channelLayouts.front().size();
 
     // Initialize JUCE message manager (required for plugin loading)
     // CRITICAL: MessageManager must be initialized on the main thread
@@ -117,10 +510,61 @@ int main (int argc, char** argv)
         return 2;
     }
 
+    if (!args.sessionPath.empty()) {
+        const int rc = runSessionGraph(args, fm, *vst3Format);
+        MessageManager::deleteInstance();
+        return rc;
+    }
+
+    // Several --plugin entries, or a --chain file, select insert-chain mode
+    std::vector<std::string> chainPaths = args.pluginPaths;
+    if (!args.chainFile.empty()) {
+        const File chainFile(args.chainFile);
+        StringArray lines;
+        lines.addLines(chainFile.loadFileAsString());
+        for (auto line : lines) {
+            line = line.trim();
+            if (line.isEmpty() || line.startsWith("#")) continue;
+            chainPaths.push_back(File::isAbsolutePath(line) ? line.toStdString()
+                                                            : chainFile.getParentDirectory().getChildFile(line).getFullPathName().toStdString());
+        }
+    }
+
+    if (chainPaths.size() > 1 || !args.chainFile.empty()) {
+        if (chainPaths.empty()) {
+            std::cerr << "Chain file lists no plugins: " << args.chainFile << "\n";
+            return 2;
+        }
+        const int rc = runPluginChain(args, chainPaths, fm, *vst3Format);
+        MessageManager::deleteInstance();
+        return rc;
+    }
+
+    // Modes that load plugins on their own report their whole run as one phase
+    if (args.memory) {
+        PhaseReport::enter("process");
+        const int rc = runMemoryProfile(args, fm, *vst3Format);
+        MessageManager::deleteInstance();
+        return rc;
+    }
+
+    if (args.lifecycleCycles > 0) {
+        PhaseReport::enter("process");
+        const int rc = runLifecycleCycles(args, fm, *vst3Format);
+        MessageManager::deleteInstance();
+        return rc;
+    }
+
+    // Every loading phase is timed; prepare and first block follow per buffer size
+    LifecycleRecord loadTimes;
+    PhaseTimer phase;
+
     // Scan the plugin file to get proper description
     std::cerr << "[DEBUG] Scanning plugin file..." << std::endl;
+    PhaseReport::enter("scan");
     OwnedArray<PluginDescription> foundPlugins;
     vst3Format->findAllTypesForFile(foundPlugins, args.pluginPath);
+    loadTimes.scanMs = phase.lapMs();
     
     if (foundPlugins.isEmpty()) {
         std::cerr << "No VST3 plugins found in: " << args.pluginPath << "\n";
@@ -135,13 +579,16 @@ int main (int argc, char** argv)
     std::cerr << "[DEBUG] Creating plugin instance (without prepareToPlay)..." << std::endl;
     // Pass 0 for block size to skip prepareToPlay() during instantiation
     // We'll call it explicitly later in the benchmark thread
+    PhaseReport::enter("load");
+    phase.lapMs();
     std::unique_ptr<AudioPluginInstance> instance(
         fm.createPluginInstance(desc, 0, 0, err)
     );
+    loadTimes.instantiateMs = phase.lapMs();
     std::cerr << "[DEBUG] Plugin instance created!" << std::endl;
 
     if (!instance) {
-        printInstantiationError(err, desc.fileOrIdentifier);
+        PluginHost::printInstantiationError(err, desc.fileOrIdentifier);
         return 2;
     }
 
@@ -149,19 +596,27 @@ int main (int argc, char** argv)
 
     std::cerr << "[DEBUG] Configuring channel layout..." << std::endl;
     int measurementChannels = args.channels;
-    if (! configureChannelLayout(*proc, args.channels, measurementChannels))
+    AudioChannelSet measurementLayout = channelLayouts.front();
+    phase.lapMs();
+    const bool layoutOk = PluginHost::configureChannelLayout(*proc, channelLayouts.front(), measurementChannels,
+                                                             &measurementLayout);
+    loadTimes.layoutMs = phase.lapMs();
+    if (! layoutOk)
     {
         std::cerr << "Unable to configure plugin for "
-                  << args.channels << " channels.\n";
+                  << PluginHost::channelLayoutName(channelLayouts.front()) << " (" << args.channels << " channels).\n";
         return 2;
     }
     std::cerr << "[DEBUG] Channel layout configured!" << std::endl;
     
     // Load StoryBored JSON preset if specified
+    StoryBoredPresetLoader::PresetData presetData;
     if (!args.presetJson.empty()) {
-        auto presetData = StoryBoredPresetLoader::loadPreset(String(args.presetJson));
+        presetData = StoryBoredPresetLoader::loadPreset(String(args.presetJson));
         if (presetData.isValid) {
+            phase.lapMs();
             int appliedCount = StoryBoredPresetLoader::applyPresetToPlugin(*proc, presetData, false);
+            loadTimes.presetMs = phase.lapMs();
             std::cerr << "Loaded preset: " << presetData.metadata.name.toStdString() 
                      << " (" << appliedCount << " parameters applied)\n";
         } else {
@@ -169,13 +624,28 @@ int main (int argc, char** argv)
         }
     }
 
+    std::cerr << "LIFECYCLE: scan=" << loadTimes.scanMs << "ms instantiate=" << loadTimes.instantiateMs
+              << "ms layout=" << loadTimes.layoutMs << "ms";
+    if (loadTimes.presetMs >= 0.0)
+        std::cerr << " preset=" << loadTimes.presetMs << "ms";
+    std::cerr << "\n";
+
     CsvSink sink;
     if (!sink.open(args.outCsv)) {
         std::cerr << "Failed to open CSV for writing: " << args.outCsv << "\n";
         return 3;
     }
 
-    sink.header();
+    if (args.scaling)
+        sink.scalingHeader();
+    else if (args.polyphonySearch)
+        sink.polyphonyHeader();
+    else if (!args.blockStream.empty())
+        sink.blockStreamHeader();
+    else if (args.channelSweep)
+        sink.channelSweepHeader();
+    else
+        sink.header(args.budgetFractions);
 
     // Collect system information once
     SystemInfo sysInfo = SystemInfo::collect();
@@ -183,11 +653,11 @@ int main (int argc, char** argv)
     const String pluginName = proc->getName();
     const String formatName = "VST3";
 
-    // Set processing precision based on bit depth
-    const bool wantsDouble = args.bitDepth == "64f";
+    // Set processing precision based on bit depth (per matrix cell below)
+    const bool wantsDouble = std::find(args.bitDepths.begin(), args.bitDepths.end(), "64f") != args.bitDepths.end();
     const bool canDouble = proc->supportsDoublePrecisionProcessing();
-    const bool useDouble = wantsDouble && canDouble;
-    const std::string bitDepthLabel = useDouble ? "64f" : "32f";
+    bool useDouble = args.bitDepth == "64f" && canDouble;
+    std::string bitDepthLabel = useDouble ? "64f" : "32f";
 
     if (wantsDouble && !canDouble) {
         std::cerr << "WARNING: Plugin does not support double precision processing; "
@@ -200,50 +670,655 @@ int main (int argc, char** argv)
         proc->setProcessingPrecision(AudioProcessor::singlePrecision);
     }
 
-    // Run measurements on dedicated real-time thread
-    for (int block : args.buffers)
+    SchedPolicy schedPolicy = SchedPolicy::None;
+    RealtimeScheduling::parsePolicy(args.sched, schedPolicy);
+
+    PacingMode pacing = PacingMode::None;
+    PeriodPacer::parseMode(args.paced, pacing);
+
+    // Resolve the timer once so fallbacks are reported up front
+    TimerBackend requestedTimer = TimerBackend::Juce;
+    BlockTimer::parseBackend(args.timer, requestedTimer);
+    const BlockTimer blockTimer(requestedTimer);
+    if (blockTimer.backend() != requestedTimer) {
+        std::cerr << "WARNING: Timer '" << args.timer << "' is not available on this machine; using '"
+                  << blockTimer.name() << "' instead.\n";
+    }
+    if (blockTimer.backend() == TimerBackend::Tsc) {
+        std::cerr << "TSC frequency: " << BlockTimer::tscHz() / 1.0e6 << " MHz (invariant)\n";
+    }
+
+    // Scaling mode: search the instance count per worker-thread count instead
+    if (args.scaling)
     {
-        if (block <= 0) continue;
-        
-        // Create a new thread instance for each buffer size
-        // (JUCE threads can only be started once)
-        BenchmarkThread benchThread;
-        
-        // Configure benchmark
-        BenchmarkConfig config;
-        config.plugin = proc;
-        config.blockSize = block;
-        config.channels = measurementChannels;
-        config.sampleRate = args.sampleRate;
-        config.warmupIterations = args.warmup;
-        config.timedIterations = args.iterations;
-        config.useDoublePrecision = useDouble;
-        config.nonRealtime = args.nonRealtime;
-        
-        // Run on real-time thread
-        BenchmarkResult result = benchThread.runBenchmark(config);
-        
-        if (!result.success)
+        PhaseReport::enter("process");
+        if (schedPolicy == SchedPolicy::Deadline) {
+            std::cerr << "WARNING: --sched deadline is not supported with --scaling; using fifo.\n";
+            schedPolicy = SchedPolicy::Fifo;
+        }
+
+        std::vector<int> threadCounts = args.scalingThreads;
+        if (threadCounts.empty()) {
+            const int cores = jmax(1, jmin(SystemStats::getNumPhysicalCpus(),
+                                           RealtimeScheduling::allowedCpuCount()));
+            for (int t = 1; t <= cores; t *= 2)
+                threadCounts.push_back(t);
+            if (threadCounts.back() != cores)
+                threadCounts.push_back(cores);
+        }
+        if (args.pinThreads && ! checkPinnedThreadCounts(threadCounts, "--scaling-threads"))
+            return 2;
+
+        // Every pooled instance gets the same layout, precision and preset as the primary one
+        auto createInstance = [&]() {
+            auto inst = PluginHost::createConfiguredInstance(fm, desc, measurementChannels, useDouble);
+            if (inst != nullptr && presetData.isValid)
+                StoryBoredPresetLoader::applyPresetToPlugin(*inst, presetData, false);
+            return inst;
+        };
+
+        for (int block : args.buffers)
+        {
+            if (block <= 0) continue;
+
+            ScalingConfig sc;
+            sc.createInstance = createInstance;
+            sc.blockSize = block;
+            sc.channels = measurementChannels;
+            sc.sampleRate = args.sampleRate;
+            sc.warmupPeriods = args.warmup;
+            sc.timedPeriods = args.iterations;
+            sc.useDoublePrecision = useDouble;
+            sc.nonRealtime = args.nonRealtime;
+            sc.schedPolicy = schedPolicy;
+            sc.rtPriority = args.rtPriority;
+            sc.timer = blockTimer.backend();
+            sc.pacing = pacing;
+            sc.targetMissRate = args.targetMissRate;
+            sc.maxInstances = args.maxInstances;
+            sc.pinThreads = args.pinThreads;
+
+            ScalingBenchmark bench(sc);
+            double basePerThread = 0.0;
+
+            for (int threads : threadCounts)
+            {
+                const ScalingPoint p = bench.measure(threads);
+                const double perThread = (double) p.maxInstances / (double) threads;
+                if (basePerThread <= 0.0) basePerThread = perThread;
+
+                // Column order must match CsvSink::scalingHeader()
+                sink.row({
+                    pluginName.toStdString(), args.pluginPath, formatName.toStdString(),
+                    std::to_string(args.sampleRate), std::to_string(measurementChannels), bitDepthLabel,
+                    std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
+                    std::to_string(threads), std::to_string(p.maxInstances), std::to_string(perThread),
+                    std::to_string(basePerThread > 0.0 ? perThread / basePerThread : 0.0),
+                    p.capped ? "1" : "0", std::to_string(args.targetMissRate),
+                    std::to_string(p.atMax.missRate), std::to_string(p.atMax.meanPeriod),
+                    std::to_string(p.atMax.p99Period), std::to_string(p.atMax.maxPeriod),
+                    std::to_string((double) block * 1e6 / args.sampleRate), std::to_string(p.trials),
+                    p.schedPolicy, blockTimer.name(),
+                    sysInfo.cpuModel.toStdString(),
+                    std::to_string(sysInfo.numPhysicalCores),
+                    std::to_string(sysInfo.cpuSpeedMHz),
+                    std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+                    sysInfo.osName.toStdString()
+                });
+            }
+        }
+
+        instance.reset();
+        MessageManager::deleteInstance();
+        return 0;
+    }
+
+    // Polyphony mode: search the held-note count per block size instead
+    if (args.polyphonySearch)
+    {
+        if (schedPolicy == SchedPolicy::Deadline) {
+            std::cerr << "WARNING: --sched deadline is not supported with --polyphony-search; using fifo.\n";
+            schedPolicy = SchedPolicy::Fifo;
+        }
+        if (! proc->acceptsMidi())
+            std::cerr << "WARNING: Plugin does not accept MIDI; every voice count will cost the same.\n";
+
+        for (int block : args.buffers)
         {
-            std::cerr << "Benchmark failed for buffer size " << block 
-                      << ": " << result.errorMessage << "\n";
-            continue;
+            if (block <= 0) continue;
+
+            PolyphonyConfig pc;
+            pc.plugin = proc;
+            pc.blockSize = block;
+            pc.channels = measurementChannels;
+            pc.sampleRate = args.sampleRate;
+            pc.warmupPeriods = args.warmup;
+            pc.timedPeriods = args.iterations;
+            pc.useDoublePrecision = useDouble;
+            pc.nonRealtime = args.nonRealtime;
+            pc.schedPolicy = schedPolicy;
+            pc.rtPriority = args.rtPriority;
+            pc.timer = blockTimer.backend();
+            pc.pacing = pacing;
+            pc.targetMissRate = args.targetMissRate;
+            pc.maxVoices = args.maxVoices;
+            pc.velocity = args.midiVelocityMax;
+
+            const PolyphonyResult r = PolyphonySearch(pc).measure();
+            const double budget = (double) block * 1e6 / args.sampleRate;
+
+            // A voice limit inside the plugin (stealing) flattens the curve instead of failing
+            if (r.capped)
+                std::cerr << "WARNING: [polyphony block=" << block << "] no miss up to " << r.maxVoices
+                          << " voices; the plugin may cap its own polyphony.\n";
+
+            // Column order must match CsvSink::polyphonyHeader()
+            sink.row({
+                pluginName.toStdString(), args.pluginPath, formatName.toStdString(),
+                std::to_string(args.sampleRate), std::to_string(measurementChannels), bitDepthLabel,
+                std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
+                std::to_string(r.maxVoices), r.capped ? "1" : "0", std::to_string(args.targetMissRate),
+                std::to_string(r.atMax.missRate), std::to_string(r.atMax.meanBlock),
+                std::to_string(r.atMax.p99Block), std::to_string(r.atMax.maxBlock),
+                std::to_string(r.idle.meanBlock), std::to_string(r.perVoiceUs),
+                std::to_string(budget > 0.0 ? 100.0 * r.perVoiceUs / budget : 0.0),
+                std::to_string(budget), std::to_string(r.trials),
+                r.schedPolicy, blockTimer.name(),
+                sysInfo.cpuModel.toStdString(),
+                std::to_string(sysInfo.numPhysicalCores),
+                std::to_string(sysInfo.cpuSpeedMHz),
+                std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+                sysInfo.osName.toStdString()
+            });
+        }
+
+        instance.reset();
+        MessageManager::deleteInstance();
+        return 0;
+    }
+
+    // Block-stream mode: varying call sizes against each prepared maximum
+    if (!args.blockStream.empty())
+    {
+        BlockPattern pattern = BlockPattern::Random;
+        BlockStream::parsePattern(args.blockStream, pattern);
+
+        std::vector<int> trace;
+        if (pattern == BlockPattern::Trace) {
+            String traceError;
+            if (! BlockStream::loadTrace(File(args.blockTrace), trace, traceError)) {
+                std::cerr << "Block trace unusable: " << traceError << "\n";
+                return 2;
+            }
         }
+
+        // Runs on the calling thread, FIFO only while it processes, as chain mode does
+        if (schedPolicy == SchedPolicy::Deadline)
+            std::cerr << "WARNING: --sched deadline is not supported with --block-stream; using fifo.\n";
+
+        std::unique_ptr<ParameterAutomation> automation;
+        if (!args.automate.empty()) {
+            AutomationShape shape = AutomationShape::Ramp;
+            ParameterAutomation::parseShape(args.automationShape, shape);
+            automation = std::make_unique<ParameterAutomation>(*proc, args.automate, shape, 1,
+                                                               jmax(2, (int) args.splitRate));
+            if (automation->empty()) {
+                std::cerr << "WARNING: No parameters matched --automate; splitting without parameter changes\n";
+                automation.reset();
+            }
+        }
+
+        for (int block : args.buffers)
+        {
+            if (block <= 0) continue;
+
+            BlockStreamConfig bc;
+            bc.plugin = proc;
+            bc.maxBlock = block;
+            bc.channels = measurementChannels;
+            bc.sampleRate = args.sampleRate;
+            bc.warmupCalls = args.warmup;
+            bc.timedCalls = args.iterations;
+            bc.useDoublePrecision = useDouble;
+            bc.nonRealtime = args.nonRealtime;
+            bc.timer = blockTimer.backend();
+            bc.pattern = pattern;
+            bc.minBlock = args.blockMin;
+            bc.splitRate = args.splitRate;
+            bc.trace = trace;
+            bc.automation = automation.get();
+            bc.fifo = schedPolicy != SchedPolicy::None;
+            bc.rtPriority = args.rtPriority;
+
+            const BlockStreamResult r = VariableBlockBenchmark::measure(bc);
+
+            std::cerr << "BLOCK-STREAM [max=" << block << "]: per call overhead " << r.callOverheadUs
+                      << "us, " << r.fitNsPerSample << "ns/sample (fixed " << r.fixed.nsPerSample << "ns/sample)\n";
+
+            // Column order must match CsvSink::blockStreamHeader()
+            auto rowFor = [&](const std::string& bucket, const BlockSizeBucket& b, bool withFit) {
+                return std::vector<std::string> {
+                    pluginName.toStdString(), args.pluginPath, formatName.toStdString(),
+                    std::to_string(args.sampleRate), std::to_string(measurementChannels), bitDepthLabel,
+                    std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
+                    BlockStream::name(pattern), bucket, std::to_string(b.minSize), std::to_string(b.maxSize),
+                    std::to_string(b.calls), std::to_string(b.samples),
+                    std::to_string(b.meanCall), std::to_string(b.p99Call), std::to_string(b.maxCall),
+                    std::to_string(b.nsPerSample),
+                    std::to_string(r.fixed.nsPerSample > 0.0 ? b.nsPerSample / r.fixed.nsPerSample : 0.0),
+                    std::to_string(b.misses),
+                    std::to_string(b.calls > 0 ? (double) b.misses / (double) b.calls : 0.0),
+                    withFit ? std::to_string(r.callOverheadUs) : std::string(),
+                    withFit ? std::to_string(r.fitNsPerSample) : std::string(),
+                    r.schedPolicy, blockTimer.name(),
+                    sysInfo.cpuModel.toStdString(),
+                    std::to_string(sysInfo.numPhysicalCores),
+                    std::to_string(sysInfo.cpuSpeedMHz),
+                    std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+                    sysInfo.osName.toStdString()
+                };
+            };
+
+            sink.row(rowFor("fixed", r.fixed, false));
+            for (const auto& b : r.buckets)
+                sink.row(rowFor(std::to_string(b.minSize) + "-" + std::to_string(b.maxSize), b, false));
+            sink.row(rowFor("all", r.all, true));
+        }
+
+        automation.reset();
+        instance.reset();
+        MessageManager::deleteInstance();
+        return 0;
+    }
+
+    // Channel sweep: the default pass for every --channels layout, with a
+    // straight-line fit of the mean over the channel count
+    if (args.channelSweep)
+    {
+        // Fewest channels first, so each marginal cost is against the next smaller layout
+        std::vector<AudioChannelSet> sweep = channelLayouts;
+        std::stable_sort(sweep.begin(), sweep.end(),
+                         [](const AudioChannelSet& a, const AudioChannelSet& b) { return a.size() < b.size(); });
+
+        for (int block : args.buffers)
+        {
+            if (block <= 0) continue;
+
+            const double budget = (double) block * 1e6 / args.sampleRate;
+            std::string grantedPolicy;
+            double sx = 0, sy = 0, sxx = 0, sxy = 0;
+            int points = 0, prevChannels = 0;
+            double prevMean = 0.0;
+
+            // Column order must match CsvSink::channelSweepHeader()
+            auto rowFor = [&](const std::string& kind, const std::string& layout, const std::string& channels,
+                              const std::vector<std::string>& measured, const std::string& missRate) {
+                std::vector<std::string> row {
+                    pluginName.toStdString(), args.pluginPath, formatName.toStdString(),
+                    std::to_string(args.sampleRate), bitDepthLabel,
+                    std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
+                    kind, layout, channels
+                };
+                row.insert(row.end(), measured.begin(), measured.end());
+                row.insert(row.end(), {
+                    std::to_string(budget), missRate, grantedPolicy, blockTimer.name(),
+                    sysInfo.cpuModel.toStdString(),
+                    std::to_string(sysInfo.numPhysicalCores),
+                    std::to_string(sysInfo.cpuSpeedMHz),
+                    std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+                    sysInfo.osName.toStdString()
+                });
+                return row;
+            };
+
+            for (const auto& layout : sweep)
+            {
+                int configured = layout.size();
+                AudioChannelSet granted = layout;
+                if (! PluginHost::configureChannelLayout(*proc, layout, configured, &granted)) {
+                    std::cerr << "WARNING: Unable to configure plugin for " << PluginHost::channelLayoutName(layout)
+                              << "; leaving it out of the sweep.\n";
+                    continue;
+                }
+
+                BenchmarkThread benchThread;
+                BenchmarkConfig config;
+                config.plugin = proc;
+                config.blockSize = block;
+                config.channels = configured;
+                config.sampleRate = args.sampleRate;
+                config.warmupIterations = args.warmup;
+                config.timedIterations = args.iterations;
+                config.useDoublePrecision = useDouble;
+                config.nonRealtime = args.nonRealtime;
+                config.schedPolicy = schedPolicy;
+                config.rtPriority = args.rtPriority;
+                config.deadlineRuntimePct = args.deadlineRuntimePct;
+                config.timer = blockTimer.backend();
+                config.budgetFractions = args.budgetFractions;
+                config.pacing = pacing;
+
+                const BenchmarkResult result = benchThread.runBenchmark(config);
+                if (!result.success) {
+                    std::cerr << "Benchmark failed for " << PluginHost::channelLayoutName(granted)
+                              << " at buffer size " << block << ": " << result.errorMessage << "\n";
+                    continue;
+                }
+                grantedPolicy = result.schedPolicy;
+
+                const Stats& st = result.scenarios.front().stats;
+                const bool hasMarginal = points > 0 && configured > prevChannels;
+                const double marginal = hasMarginal ? (st.mean - prevMean) / (configured - prevChannels) : 0.0;
+
+                sink.row(rowFor("layout", PluginHost::channelLayoutName(granted).toStdString(), std::to_string(configured), {
+                    std::to_string(st.mean), std::to_string(st.p99), std::to_string(st.max),
+                    std::to_string(st.mean / configured), hasMarginal ? std::to_string(marginal) : std::string(),
+                    std::string(), std::string()
+                }, std::to_string(st.deadlineMissRate)));
+
+                sx += configured;
+                sy += st.mean;
+                sxx += (double) configured * configured;
+                sxy += configured * st.mean;
+                ++points;
+                prevChannels = configured;
+                prevMean = st.mean;
+            }
+
+            // Least-squares line: mean = base + channels * per-channel cost
+            const double den = points * sxx - sx * sx;
+            if (points >= 2 && den > 0.0)
+            {
+                const double slope = (points * sxy - sx * sy) / den;
+                const double base = (sy - slope * sx) / points;
+                std::cerr << "CHANNEL-SWEEP [buffer=" << block << "]: " << slope << "us per channel, "
+                          << base << "us base\n";
+                sink.row(rowFor("fit", "", "", {
+                    "", "", "", "", "", std::to_string(base), std::to_string(slope)
+                }, ""));
+            }
+            else
+            {
+                std::cerr << "WARNING [buffer=" << block << "]: fewer than two layouts were accepted; no per-channel fit\n";
+            }
+        }
+
+        instance.reset();
+        MessageManager::deleteInstance();
+        return 0;
+    }
+
+    // Program material: decoded on a background thread for the whole run,
+    // with as many channels as the widest matrix cell
+    std::unique_ptr<FileInputSource> fileInput;
+    if (!args.inputFiles.empty() || !args.inputDirs.empty())
+    {
+        const int maxBlock = *std::max_element(args.buffers.begin(), args.buffers.end());
+        int maxChannels = 0;
+        for (const auto& set : channelLayouts)
+            maxChannels = jmax(maxChannels, set.size());
+        fileInput = std::make_unique<FileInputSource>(FileInputSource::collect(args.inputFiles, args.inputDirs),
+                                                      maxChannels, maxBlock);
+        String inputError;
+        if (! fileInput->open(inputError)) {
+            std::cerr << "Input files unusable: " << inputError << "\n";
+            return 2;
+        }
+        std::cerr << "Input: " << fileInput->filesOpened() << " file(s) opened, "
+                  << fileInput->filesMapped() << " memory-mapped\n";
+    }
+
+    // --sr/--channels/--bits lists: every combination runs against the same
+    // loaded instance. The channel layout, the costliest change, is switched
+    // least often; BenchmarkThread re-prepares for every block size anyway.
+    // --sidechain adds an innermost axis: auxiliary inputs off (0), then on (1)
+    struct MatrixCell { AudioChannelSet layout; std::string bits; double sampleRate; int sidechain; };
+    std::vector<MatrixCell> cells;
+    const std::vector<int> sidechainStates = args.sidechain ? std::vector<int> { 0, 1 } : std::vector<int> { -1 };
+    for (const auto& layout : channelLayouts)
+        for (const auto& bits : args.bitDepths)
+            for (double sr : args.sampleRates)
+                for (int sc : sidechainStates)
+                    cells.push_back({ layout, bits, sr, sc });
+
+    Stimulus sidechainStimulus = Stimulus::Transient;
+    SignalGenerator::parse(args.sidechainStimulus, sidechainStimulus);
+    std::map<std::pair<int, std::string>, double> sidechainOffMeans; // (block, scenario) -> mean with aux inputs off
+
+    AudioChannelSet requestedLayout = channelLayouts.front();
+    for (const auto& cell : cells)
+    {
+        const double sampleRate = cell.sampleRate;
+        int sidechainChannels = 0;
+        std::unique_ptr<SignalGenerator> sidechainKey;
+        if (cells.size() > 1)
+        {
+            // Layout and precision may only change while the plugin is released
+            proc->releaseResources();
+            if (cell.layout != requestedLayout) {
+                int configured = cell.layout.size();
+                requestedLayout = cell.layout;
+                if (! PluginHost::configureChannelLayout(*proc, cell.layout, configured, &measurementLayout)) {
+                    std::cerr << "WARNING: Unable to configure plugin for "
+                              << PluginHost::channelLayoutName(cell.layout) << "; skipping that cell.\n";
+                    requestedLayout = AudioChannelSet::disabled(); // layout unknown, so the next cell sets it again
+                    continue;
+                }
+                measurementChannels = configured;
+            }
+            useDouble = cell.bits == "64f" && canDouble;
+            bitDepthLabel = useDouble ? "64f" : "32f";
+            proc->setProcessingPrecision(useDouble ? AudioProcessor::doublePrecision
+                                                   : AudioProcessor::singlePrecision);
+            if (cell.sidechain >= 0) {
+                sidechainChannels = PluginHost::configureAuxInputs(*proc, cell.sidechain == 1);
+                if (cell.sidechain == 0)
+                    sidechainOffMeans.clear();
+                if (cell.sidechain == 1 && sidechainChannels == 0) {
+                    std::cerr << "WARNING: Plugin has no auxiliary input that could be enabled; "
+                              << "skipping the sidechain-on cell.\n";
+                    continue;
+                }
+                if (sidechainChannels > 0)
+                    sidechainKey = std::make_unique<SignalGenerator>(sidechainStimulus, sampleRate, sidechainChannels);
+            }
+            std::cerr << "MATRIX: sr=" << sampleRate << " channels=" << measurementChannels
+                      << " layout=" << PluginHost::channelLayoutName(measurementLayout)
+                      << " bits=" << bitDepthLabel;
+            if (cell.sidechain >= 0)
+                std::cerr << " sidechain=" << (cell.sidechain == 1 ? "on" : "off") << " (" << sidechainChannels << " ch)";
+            std::cerr << "\n";
+        }
+        
+        // Every input and output channel of every enabled bus needs a buffer channel
+        const int bufferChannels = jmax(measurementChannels, proc->getTotalNumInputChannels(),
+                                        proc->getTotalNumOutputChannels());
+
+        // Run measurements (inline, or on a dedicated real-time thread with --sched)
+        for (int block : args.buffers)
+        {
+            if (block <= 0) continue;
         
-        const Stats& s = result.stats;
-        sink.row({ pluginName.toStdString(), args.pluginPath, formatName.toStdString(),
-                   std::to_string(args.sampleRate), std::to_string(measurementChannels), bitDepthLabel,
-                   std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
-                   std::to_string(s.mean), std::to_string(s.median), std::to_string(s.p95),
-                   std::to_string(s.min), std::to_string(s.max), std::to_string(s.stdDev),
-                   std::to_string(s.cv), std::to_string(s.rtPct), std::to_string(s.dspLoad),
-                   std::to_string(s.latency),
-                   sysInfo.cpuModel.toStdString(),
-                   std::to_string(sysInfo.numPhysicalCores),
-                   std::to_string(sysInfo.cpuSpeedMHz),
-                   std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
-                   sysInfo.osName.toStdString() });
+            // Create a new thread instance for each buffer size
+            // (JUCE threads can only be started once)
+            BenchmarkThread benchThread;
+
+            // Configure benchmark
+            BenchmarkConfig config;
+            config.plugin = proc;
+            config.blockSize = block;
+            config.channels = bufferChannels;
+            config.sampleRate = sampleRate;
+            config.warmupIterations = args.warmup;
+            config.timedIterations = args.iterations;
+            config.useDoublePrecision = useDouble;
+            config.nonRealtime = args.nonRealtime;
+            config.schedPolicy = schedPolicy;
+            config.rtPriority = args.rtPriority;
+            config.deadlineRuntimePct = args.deadlineRuntimePct;
+            config.timer = blockTimer.backend();
+            config.perfCounters = args.perfCounters;
+            config.budgetFractions = args.budgetFractions;
+            config.pacing = pacing;
+            config.coldCache = args.coldCache;
+            config.evictBytes = (size_t) args.evictKb * 1024;
+            config.flushIoBuffers = args.flushBuffers;
+            config.rtAudit = args.rtAudit;
+            config.rtAuditBacktraces = args.rtAuditBacktraces;
+            config.osNoise = args.osNoise;
+            config.osNoiseTop = args.osNoiseTop;
+            config.fileInput = fileInput.get();
+            config.denormals = args.denormals;
+            config.automate = args.automate;
+            ParameterAutomation::parseShape(args.automationShape, config.automationShape);
+            config.automationEvery = args.automationEvery;
+            config.midiPolyphony = args.midiPolyphony;
+            config.midi.notesPerSecond = args.midiDensity;
+            config.midi.noteLengthSec = args.midiNoteLength;
+            config.midi.velocityMin = args.midiVelocityMin;
+            config.midi.velocityMax = args.midiVelocityMax;
+            config.midi.ccPerSecond = args.midiCcRate;
+            config.midi.ccNumber = args.midiCc;
+            config.midi.bendPerSecond = args.midiBendRate;
+            config.midi.mpe = args.mpe;
+            config.sidechain = sidechainKey.get();
+            config.sidechainOffset = proc->getChannelCountOfBus(true, 0);
+            config.sidechainChannels = sidechainChannels;
+            for (const auto& name : args.stimuli) {
+                Stimulus st;
+                if (SignalGenerator::parse(name, st))
+                    config.stimuli.push_back(st);
+            }
+
+            // Run inline or on the configured real-time thread
+            BenchmarkResult result = benchThread.runBenchmark(config);
+
+            if (!result.success)
+            {
+                std::cerr << "Benchmark failed for buffer size " << block 
+                          << ": " << result.errorMessage << "\n";
+                continue;
+            }
+
+            // One row per scenario; the first (default) pass is the reference
+            const double defaultMean = result.scenarios.front().stats.mean;
+            std::cerr << "LIFECYCLE [buffer=" << block << "]: prepare=" << result.prepareMs << "ms";
+            if (result.firstBlockUs >= 0.0 && defaultMean > 0.0)
+                std::cerr << " first_block=" << result.firstBlockUs << "us (" << result.firstBlockUs / defaultMean
+                          << "x mean)";
+            std::cerr << "\n";
+            auto phaseCol = [](double v) { return v >= 0.0 ? std::to_string(v) : std::string(); };
+
+            for (const auto& scenario : result.scenarios)
+            {
+                const Stats& s = scenario.stats;
+
+                // Passes without FTZ/DAZ are compared with the same pass with the flags set
+                double noFtzSlowdown = 0.0;
+                for (const auto& ref : result.scenarios)
+                    if (!scenario.ftzReference.empty() && ref.name == scenario.ftzReference && ref.stats.mean > 0.0)
+                        noFtzSlowdown = s.mean / ref.stats.mean;
+                if (noFtzSlowdown >= 2.0) {
+                    std::cerr << "WARNING [buffer=" << block << ", " << scenario.name << "]: " << noFtzSlowdown
+                              << "x slower without FTZ/DAZ - the plugin relies on the host to flush denormals\n";
+                }
+
+                // Sidechain-on cells are compared with the same block and pass with aux inputs off
+                double sidechainSlowdown = 0.0;
+                if (cell.sidechain == 0) {
+                    sidechainOffMeans[{ block, scenario.name }] = s.mean;
+                } else if (cell.sidechain == 1) {
+                    const auto off = sidechainOffMeans.find({ block, scenario.name });
+                    if (off != sidechainOffMeans.end() && off->second > 0.0)
+                        sidechainSlowdown = s.mean / off->second;
+                }
+
+                // Counter columns stay empty when the counter was not available
+                auto counter = [&](PerfCounterGroup::Counter c, double v) {
+                    return s.hwCounters && s.hwAvailable[(size_t) c] ? std::to_string(v) : std::string();
+                };
+
+                // Paced-mode columns stay empty for back-to-back runs
+                auto pacedCol = [&](const std::string& v) { return s.paced ? v : std::string(); };
+
+                // Audit columns stay empty without --rt-audit (syscalls also when uncountable)
+                auto auditCol = [&](const std::string& v) { return s.rtAudit ? v : std::string(); };
+                auto osCol = [&](const std::string& v) { return s.osNoise ? v : std::string(); };
+
+                // Column order must match CsvSink::header()
+                std::vector<std::string> row {
+                    pluginName.toStdString(), args.pluginPath, formatName.toStdString(),
+                    std::to_string(sampleRate), std::to_string(measurementChannels),
+                    PluginHost::channelLayoutName(measurementLayout).toStdString(), bitDepthLabel,
+                    std::to_string(args.warmup), std::to_string(args.iterations), std::to_string(block),
+                    scenario.name, std::to_string(defaultMean > 0.0 ? s.mean / defaultMean : 0.0),
+                    scenario.ftzReference.empty() ? "1" : "0",
+                    noFtzSlowdown > 0.0 ? std::to_string(noFtzSlowdown) : std::string(),
+                    scenario.midiPolyphony > 0 ? std::to_string(scenario.midiPolyphony) : std::string(),
+                    scenario.midiPolyphony > 0 ? std::to_string(scenario.midiEventsPerBlock) : std::string(),
+                    scenario.midiPolyphony > 0 ? std::to_string(scenario.midiPeakVoices) : std::string(),
+                    scenario.midiPolyphony > 0 ? std::to_string(scenario.midiMeanVoices) : std::string(),
+                    cell.sidechain < 0 ? std::string() : cell.sidechain == 1 ? "on" : "off",
+                    cell.sidechain < 0 ? std::string() : std::to_string(sidechainChannels),
+                    sidechainSlowdown > 0.0 ? std::to_string(sidechainSlowdown) : std::string(),
+                    std::to_string(s.mean), std::to_string(s.median), std::to_string(s.p90),
+                    std::to_string(s.p95), std::to_string(s.p99), std::to_string(s.p999),
+                    std::to_string(s.p9999),
+                    std::to_string(s.min), std::to_string(s.max), std::to_string(s.stdDev),
+                    std::to_string(s.cv), std::to_string(s.rtPct), std::to_string(s.dspLoad),
+                    std::to_string(s.latency), result.schedPolicy,
+                    std::to_string(s.maxOverBudget), std::to_string(s.deadlineMisses),
+                    std::to_string(s.deadlineMissRate)
+                };
+
+                for (size_t f = 0; f < s.overBudgetFraction.size(); ++f) {
+                    row.push_back(std::to_string(s.overBudgetFraction[f]));
+                    row.push_back(std::to_string(s.overBudgetFractionRate[f]));
+                }
+
+                row.insert(row.end(), {
+                    PeriodPacer::modeName(pacing),
+                    pacedCol(std::to_string(s.wakeJitterMean)), pacedCol(std::to_string(s.wakeJitterP99)),
+                    pacedCol(std::to_string(s.wakeJitterMax)), pacedCol(std::to_string(s.xruns)),
+                    blockTimer.name(),
+                    counter(PerfCounterGroup::Cycles, s.hwCycles),
+                    counter(PerfCounterGroup::Instructions, s.hwInstructions),
+                    counter(PerfCounterGroup::Instructions, s.ipc),
+                    counter(PerfCounterGroup::BranchMisses, s.branchMisses),
+                    counter(PerfCounterGroup::L1dMisses, s.l1dMisses),
+                    counter(PerfCounterGroup::LlcMisses, s.llcMisses),
+                    counter(PerfCounterGroup::DtlbMisses, s.dtlbMisses),
+                    auditCol(std::to_string(s.rtAllocs)), auditCol(std::to_string(s.rtFrees)),
+                    auditCol(std::to_string(s.rtAllocBytes)), auditCol(std::to_string(s.rtLockOps)),
+                    auditCol(std::to_string(s.rtCondOps)),
+                    s.rtSyscalls >= 0 ? std::to_string(s.rtSyscalls) : std::string(),
+                    auditCol(std::to_string(s.rtUnsafeBlocks)),
+                    osCol(std::to_string(s.osMinorFaults)), osCol(std::to_string(s.osMajorFaults)),
+                    osCol(std::to_string(s.osVoluntarySwitches)), osCol(std::to_string(s.osInvoluntarySwitches)),
+                    osCol(std::to_string(s.osRunQueueWait)), osCol(std::to_string(s.osNoisyBlocks)),
+                    osCol(std::to_string(s.osNoisyMean)), osCol(std::to_string(s.osQuietMean)),
+                    osCol(std::to_string(s.osQuietP99)),
+                    phaseCol(loadTimes.scanMs), phaseCol(loadTimes.instantiateMs),
+                    phaseCol(loadTimes.layoutMs), phaseCol(loadTimes.presetMs),
+                    phaseCol(result.prepareMs), phaseCol(result.firstBlockUs),
+                    result.firstBlockUs >= 0.0 && s.mean > 0.0 ? std::to_string(result.firstBlockUs / s.mean) : std::string(),
+                    sysInfo.cpuModel.toStdString(),
+                    std::to_string(sysInfo.numPhysicalCores),
+                    std::to_string(sysInfo.cpuSpeedMHz),
+                    std::to_string(sysInfo.totalRAM / (1024.0 * 1024.0 * 1024.0)),
+                    sysInfo.osName.toStdString()
+                });
+
+                sink.row(row);
+            }
+        }
+    }
+
+    if (fileInput != nullptr && fileInput->underruns() > 0) {
+        std::cerr << "WARNING: The decoder fell behind " << fileInput->underruns()
+                  << " time(s); those blocks waited outside the timed region\n";
     }
+    fileInput.reset();
 
     // Clean up plugin instance before message manager
     instance.reset();
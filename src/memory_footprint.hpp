@@ -0,0 +1,263 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+ #include <malloc.h>
+#endif
+
+#include "plugin_host.hpp"
+
+using namespace juce;
+
+/**
+ * Process memory from /proc/self/smaps_rollup, in KiB. RSS counts every
+ * resident page; PSS splits shared pages between the processes mapping them;
+ * USS (Private_Clean + Private_Dirty) is what this process alone would free.
+ */
+struct MemorySample {
+    int64 rssKb = -1;
+    int64 pssKb = -1;
+    int64 ussKb = -1;
+
+    bool valid() const { return rssKb >= 0; }
+
+    MemorySample operator-(const MemorySample& o) const {
+        return { rssKb - o.rssKb, pssKb - o.pssKb, ussKb - o.ussKb };
+    }
+
+    /**
+     * Read the current footprint. Freed heap memory is handed back to the
+     * kernel first (malloc_trim on glibc) so allocator caching is not
+     * mistaken for growth.
+     */
+    static MemorySample read() {
+        MemorySample s;
+       #if defined(__GLIBC__)
+        malloc_trim(0);
+       #endif
+        std::ifstream in("/proc/self/smaps_rollup");
+        if (!in) return s;
+
+        int64 privateClean = 0, privateDirty = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ss(line);
+            std::string key;
+            int64 kb = 0;
+            if (!(ss >> key >> kb)) continue;
+            if (key == "Rss:") s.rssKb = kb;
+            else if (key == "Pss:") s.pssKb = kb;
+            else if (key == "Private_Clean:") privateClean = kb;
+            else if (key == "Private_Dirty:") privateDirty = kb;
+        }
+        if (s.rssKb >= 0) s.ussKb = privateClean + privateDirty;
+        return s;
+    }
+};
+
+/** One point of the memory profile, with its growth over the pre-load baseline. */
+struct MemoryStage {
+    std::string stage;
+    int blockSize = 0;   // 0 where no block size applies
+    int instances = 0;   // live instances when sampled
+    int cycle = -1;      // cycle number for the leak stages
+    MemorySample absolute;
+    MemorySample delta;  // vs. the baseline, or the derived figure for summary stages
+};
+
+struct MemoryConfig {
+    String pluginPath;
+    int channels = 2;
+    bool useDoublePrecision = false;
+    double sampleRate = 48000.0;
+    std::vector<int> blockSizes;
+    bool nonRealtime = false;
+    int blocksAfterPrepare = 16;  // processBlock calls after each prepareToPlay
+    int extraInstances = 4;       // K
+    int cycles = 10;              // leak-check cycles
+    std::function<void (AudioPluginInstance&)> applyPreset; // optional
+};
+
+/**
+ * Memory footprint of a plugin: what loading the binary and one instance
+ * costs, what each prepareToPlay adds, how much a further instance costs
+ * (so a shared and a per-instance part can be told apart), and whether
+ * repeated release/prepare or create/destroy cycles keep growing.
+ * Must run on the message thread.
+ */
+class MemoryProfiler {
+public:
+    explicit MemoryProfiler(AudioPluginFormatManager& fm, AudioPluginFormat& format, const MemoryConfig& cfg)
+        : fm_(fm), format_(format), cfg_(cfg) {}
+
+    bool run(std::vector<MemoryStage>& stages, String& error)
+    {
+        baseline_ = MemorySample::read();
+        if (! baseline_.valid()) {
+            error = "/proc/self/smaps_rollup is not readable (needs Linux 4.14 or later)";
+            return false;
+        }
+        stages.clear();
+        add(stages, "baseline", baseline_, 0, 0);
+
+        OwnedArray<PluginDescription> found;
+        format_.findAllTypesForFile(found, cfg_.pluginPath);
+        if (found.isEmpty()) {
+            error = "No VST3 plugins found in: " + cfg_.pluginPath;
+            return false;
+        }
+        desc_ = *found[0];
+        add(stages, "scanned", MemorySample::read(), 0, 0);
+
+        auto primary = createInstance(error);
+        if (primary == nullptr)
+            return false;
+        add(stages, "instantiated", MemorySample::read(), 0, 1);
+
+        int lastBlock = 0;
+        for (int block : cfg_.blockSizes) {
+            if (block <= 0) continue;
+            prepareAndProcess(*primary, block);
+            lastBlock = block;
+            add(stages, "prepared", MemorySample::read(), block, 1);
+        }
+        if (lastBlock <= 0) {
+            error = "no positive buffer size";
+            return false;
+        }
+        const MemorySample onePrepared = MemorySample::read();
+
+        // K more instances at the last block size: the slope is the per-instance cost
+        const int k = cfg_.extraInstances;
+        if (k > 0) {
+            std::vector<std::unique_ptr<AudioPluginInstance>> extras;
+            for (int i = 0; i < k; ++i) {
+                auto inst = createInstance(error);
+                if (inst == nullptr)
+                    return false;
+                prepareAndProcess(*inst, lastBlock);
+                extras.push_back(std::move(inst));
+            }
+            const MemorySample withExtras = MemorySample::read();
+            add(stages, "extra_instances", withExtras, lastBlock, 1 + k);
+
+            const MemorySample added = withExtras - onePrepared;
+            const MemorySample perInstance { added.rssKb / k, added.pssKb / k, added.ussKb / k };
+            const MemorySample first = onePrepared - baseline_;
+            addSummary(stages, "per_instance", perInstance, lastBlock, 1);
+            addSummary(stages, "shared", first - perInstance, lastBlock, 1);
+
+            for (auto& inst : extras)
+                inst->releaseResources();
+            extras.clear();
+            add(stages, "extras_destroyed", MemorySample::read(), lastBlock, 1);
+        }
+
+        if (cfg_.cycles <= 0)
+            return true;
+
+        // Leak check 1: releaseResources/prepareToPlay on the same instance
+        MemorySample afterFirst;
+        for (int c = 0; c < cfg_.cycles; ++c) {
+            prepareAndProcess(*primary, lastBlock);
+            const MemorySample s = MemorySample::read();
+            if (c == 0) afterFirst = s;
+            if (c == 0 || c == cfg_.cycles - 1)
+                add(stages, "prepare_cycle", s, lastBlock, 1, c);
+            if (c == cfg_.cycles - 1 && c > 0)
+                addSummary(stages, "prepare_cycle_growth", perCycle(s - afterFirst, c), lastBlock, 1);
+        }
+
+        // Leak check 2: create, prepare, process and destroy a second instance
+        for (int c = 0; c < cfg_.cycles; ++c) {
+            {
+                auto inst = createInstance(error);
+                if (inst == nullptr)
+                    return false;
+                prepareAndProcess(*inst, lastBlock);
+                inst->releaseResources();
+            }
+            const MemorySample s = MemorySample::read();
+            if (c == 0) afterFirst = s;
+            if (c == 0 || c == cfg_.cycles - 1)
+                add(stages, "create_destroy_cycle", s, lastBlock, 1, c);
+            if (c == cfg_.cycles - 1 && c > 0)
+                addSummary(stages, "create_destroy_growth", perCycle(s - afterFirst, c), lastBlock, 1);
+        }
+
+        primary->releaseResources();
+        return true;
+    }
+
+private:
+    std::unique_ptr<AudioPluginInstance> createInstance(String& error)
+    {
+        auto inst = PluginHost::createConfiguredInstance(fm_, desc_, cfg_.channels, cfg_.useDoublePrecision);
+        if (inst == nullptr) {
+            error = "instantiation failed";
+            return nullptr;
+        }
+        if (cfg_.applyPreset)
+            cfg_.applyPreset(*inst);
+        return inst;
+    }
+
+    /** Re-prepare and run a few blocks, so buffers allocated lazily on the first block count too. */
+    void prepareAndProcess(AudioPluginInstance& plug, int block)
+    {
+        plug.releaseResources();
+        plug.setNonRealtime(cfg_.nonRealtime);
+        plug.prepareToPlay(cfg_.sampleRate, block);
+
+        if (plug.isUsingDoublePrecision())
+            process<double>(plug, block);
+        else
+            process<float>(plug, block);
+    }
+
+    template <typename Sample>
+    void process(AudioPluginInstance& plug, int block)
+    {
+        ScopedNoDenormals noDenormals;
+        AudioBuffer<Sample> buf(cfg_.channels, block);
+        MidiBuffer midi;
+
+        Random rng(12345);
+        for (int c = 0; c < buf.getNumChannels(); ++c)
+            for (int n = 0; n < buf.getNumSamples(); ++n)
+                buf.setSample(c, n, (Sample)((rng.nextFloat() * 2.0f - 1.0f) * 0.1f));
+
+        for (int i = 0; i < jmax(1, cfg_.blocksAfterPrepare); ++i) {
+            midi.clear();
+            plug.processBlock(buf, midi);
+        }
+    }
+
+    static MemorySample perCycle(const MemorySample& growth, int cycles) {
+        return { growth.rssKb / cycles, growth.pssKb / cycles, growth.ussKb / cycles };
+    }
+
+    void add(std::vector<MemoryStage>& stages, const std::string& name, const MemorySample& s,
+             int block, int instances, int cycle = -1) const {
+        stages.push_back({ name, block, instances, cycle, s, s - baseline_ });
+    }
+
+    static void addSummary(std::vector<MemoryStage>& stages, const std::string& name,
+                           const MemorySample& derived, int block, int instances) {
+        stages.push_back({ name, block, instances, -1, MemorySample(), derived });
+    }
+
+    AudioPluginFormatManager& fm_;
+    AudioPluginFormat& format_;
+    MemoryConfig cfg_;
+    PluginDescription desc_;
+    MemorySample baseline_;
+};
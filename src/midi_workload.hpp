@@ -0,0 +1,234 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace juce;
+
+struct MidiWorkloadConfig {
+    int polyphony = 8;              // most notes held at once; the oldest is released beyond that
+    double notesPerSecond = 0.0;    // note-on density; 0 = polyphony / noteLengthSec
+    double noteLengthSec = 1.0;
+    int velocityMin = 100, velocityMax = 100;
+    int lowestNote = 36, highestNote = 96;
+    double ccPerSecond = 0.0;       // controller stream (0 = off)
+    int ccNumber = 1;
+    double bendPerSecond = 0.0;     // pitch-bend stream (0 = off)
+    bool mpe = false;               // one member channel per note, per-note bend/pressure/CC74
+};
+
+/**
+ * Pre-rendered MIDI performance for instrument benchmarks.
+ *
+ * A loop of a few seconds is generated once per block size: note-ons at the
+ * configured density (with seeded timing jitter), held up to the polyphony
+ * limit, plus optional CC and pitch-bend streams. The default density,
+ * polyphony / note length, keeps about as many notes sounding as the limit
+ * allows; peakVoices() and meanVoices() say how many actually do. Every event sits at its
+ * exact sample offset inside its block. The timed loop only copies the next
+ * ready block into the MidiBuffer it passes to processBlock. All notes are
+ * released before the loop wraps, so repeating it never leaks voices.
+ *
+ * In MPE mode notes rotate over member channels 2-16 of a lower zone, and
+ * the bend stream becomes per-note pitch bend, channel pressure and CC74 on
+ * each sounding note's channel.
+ */
+class MidiWorkload {
+public:
+    MidiWorkload(const MidiWorkloadConfig& cfg, double sampleRate, int blockSize)
+        : cfg_(cfg)
+    {
+        const int numBlocks = jmax(1, (int) std::ceil(kLoopSeconds * sampleRate / blockSize));
+        loopSamples_ = (int64) numBlocks * blockSize;
+        blocks_.resize((size_t) numBlocks);
+
+        std::vector<Event> events;
+        std::vector<Voice> voices;
+        generateNotes(sampleRate, events, voices);
+        generateStreams(sampleRate, voices, events);
+
+        // Note-offs before anything else at the same sample, note-ons last
+        std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+            return a.time != b.time ? a.time < b.time : a.order < b.order;
+        });
+
+        for (const auto& e : events)
+            blocks_[(size_t) (e.time / blockSize)].addEvent(e.message, (int) (e.time % blockSize));
+
+        totalEvents_ = (int64) events.size();
+        countVoices(voices);
+    }
+
+    int polyphony() const { return cfg_.polyphony; }
+    double eventsPerBlock() const { return (double) totalEvents_ / (double) blocks_.size(); }
+
+    /** Most notes sounding at once anywhere in the loop. */
+    int peakVoices() const { return peakVoices_; }
+
+    /** Notes sounding on average over the loop, ramp-up after each wrap included. */
+    double meanVoices() const { return meanVoices_; }
+
+    void rewind() { pos_ = 0; }
+
+    /** Append the next block's events to out (the caller clears it). */
+    void next(MidiBuffer& out) {
+        out.addEvents(blocks_[pos_], 0, -1, 0);
+        if (++pos_ == blocks_.size()) pos_ = 0;
+    }
+
+    /** Set-up messages for the start of a pass: the MPE configuration message. */
+    void prelude(MidiBuffer& out) const {
+        if (! cfg_.mpe) return;
+        // MCM: RPN 6 on the master channel, 15 member channels
+        out.addEvent(MidiMessage::controllerEvent(1, 101, 0), 0);
+        out.addEvent(MidiMessage::controllerEvent(1, 100, 6), 0);
+        out.addEvent(MidiMessage::controllerEvent(1, 6, 15), 0);
+    }
+
+    /** All Notes Off on every channel the workload uses. */
+    void allNotesOff(MidiBuffer& out) const {
+        for (int ch = 1; ch <= (cfg_.mpe ? 16 : 1); ++ch)
+            out.addEvent(MidiMessage::allNotesOff(ch), 0);
+    }
+
+private:
+    static constexpr double kLoopSeconds = 4.0;
+
+    struct Event {
+        int64 time;
+        int order;   // 0 = note-off, 1 = controllers, 2 = note-on
+        MidiMessage message;
+    };
+
+    struct Voice {
+        int note, channel;
+        int64 start, end;
+    };
+
+    void generateNotes(double sr, std::vector<Event>& events, std::vector<Voice>& all)
+    {
+        Random rng(777);
+        const double density = cfg_.notesPerSecond > 0.0 ? cfg_.notesPerSecond
+                                                         : cfg_.polyphony / jmax(0.001, cfg_.noteLengthSec);
+        const double interval = sr / jmax(0.001, density);
+        const int64 length = jmax<int64>(1, (int64) (cfg_.noteLengthSec * sr));
+        const int64 lastSample = loopSamples_ - 1;
+        std::vector<size_t> sounding; // indices into all
+        int nextChannel = 0;
+        int64 previous = -1;
+
+        auto release = [&](size_t v, int64 at) {
+            all[v].end = at;
+            events.push_back({ at, 0, MidiMessage::noteOff(all[v].channel, all[v].note, (uint8) 64) });
+        };
+
+        for (int k = 0; (double) k * interval < (double) lastSample; ++k) {
+            // Note-ons strictly after one another and before lastSample, so
+            // every note-off (sorted first at equal times) follows its note-on
+            const double jitter = k > 0 ? (rng.nextDouble() - 0.5) * 0.5 * interval : 0.0;
+            const int64 t = jmax(previous + 1, (int64) (k * interval + jitter));
+            if (t >= lastSample) break;
+            previous = t;
+
+            // Notes that have run their length, then voice stealing at the limit
+            for (size_t i = 0; i < sounding.size();) {
+                if (all[sounding[i]].end <= t) {
+                    release(sounding[i], all[sounding[i]].end);
+                    sounding.erase(sounding.begin() + (long) i);
+                } else {
+                    ++i;
+                }
+            }
+            if ((int) sounding.size() >= cfg_.polyphony && ! sounding.empty()) {
+                release(sounding.front(), t);
+                sounding.erase(sounding.begin());
+            }
+
+            // A pitch that is not already sounding
+            const int range = jmax(1, cfg_.highestNote - cfg_.lowestNote + 1);
+            int note = cfg_.lowestNote + rng.nextInt(range);
+            for (int tries = 0; tries < range; ++tries) {
+                const bool taken = std::any_of(sounding.begin(), sounding.end(),
+                                               [&](size_t v) { return all[v].note == note; });
+                if (! taken) break;
+                note = cfg_.lowestNote + (note - cfg_.lowestNote + 1) % range;
+            }
+
+            const int channel = cfg_.mpe ? 2 + (nextChannel++ % 15) : 1;
+            const int velocity = cfg_.velocityMin + rng.nextInt(jmax(1, cfg_.velocityMax - cfg_.velocityMin + 1));
+
+            all.push_back({ note, channel, t, jmin(t + length, lastSample) });
+            sounding.push_back(all.size() - 1);
+            events.push_back({ t, 2, MidiMessage::noteOn(channel, note, (uint8) jlimit(1, 127, velocity)) });
+        }
+
+        // Everything off before the loop wraps
+        for (size_t v : sounding)
+            release(v, all[v].end);
+    }
+
+    void generateStreams(double sr, const std::vector<Voice>& voices, std::vector<Event>& events) const
+    {
+        // Slow LFO shapes so consecutive values differ, as a hand on a wheel would
+        auto lfo = [sr](int64 t, double hz) { return std::sin(MathConstants<double>::twoPi * hz * (double) t / sr); };
+
+        if (cfg_.ccPerSecond > 0.0) {
+            const double step = sr / cfg_.ccPerSecond;
+            for (double t = 0; t < (double) loopSamples_; t += step) {
+                const int value = jlimit(0, 127, 64 + (int) (63.0 * lfo((int64) t, 0.5)));
+                events.push_back({ (int64) t, 1, MidiMessage::controllerEvent(1, cfg_.ccNumber, value) });
+            }
+        }
+
+        if (cfg_.bendPerSecond > 0.0) {
+            const double step = sr / cfg_.bendPerSecond;
+            for (double t = 0; t < (double) loopSamples_; t += step) {
+                const int64 at = (int64) t;
+                const int bend = jlimit(0, 16383, 8192 + (int) (8191.0 * lfo(at, 0.7)));
+
+                if (! cfg_.mpe) {
+                    events.push_back({ at, 1, MidiMessage::pitchWheel(1, bend) });
+                    continue;
+                }
+
+                // Per-note expression on every sounding note's own channel
+                for (const auto& v : voices) {
+                    if (v.start > at || v.end <= at) continue;
+                    const double phase = lfo(at + v.note * 997, 1.3);
+                    events.push_back({ at, 1, MidiMessage::pitchWheel(v.channel, bend) });
+                    events.push_back({ at, 1, MidiMessage::channelPressureChange(v.channel, jlimit(0, 127, 64 + (int) (63.0 * phase))) });
+                    events.push_back({ at, 1, MidiMessage::controllerEvent(v.channel, 74, jlimit(0, 127, 64 - (int) (63.0 * phase))) });
+                }
+            }
+        }
+    }
+
+    void countVoices(const std::vector<Voice>& voices)
+    {
+        std::vector<std::pair<int64, int>> edges; // (time, +1 start / -1 end), ends first at equal times
+        int64 soundingSamples = 0;
+        for (const auto& v : voices) {
+            edges.push_back({ v.start, 1 });
+            edges.push_back({ v.end, -1 });
+            soundingSamples += v.end - v.start;
+        }
+        std::sort(edges.begin(), edges.end());
+
+        int sounding = 0;
+        for (const auto& e : edges) {
+            sounding += e.second;
+            peakVoices_ = jmax(peakVoices_, sounding);
+        }
+        meanVoices_ = (double) soundingSamples / (double) loopSamples_;
+    }
+
+    MidiWorkloadConfig cfg_;
+    std::vector<MidiBuffer> blocks_;
+    int64 loopSamples_ = 0;
+    int64 totalEvents_ = 0;
+    int peakVoices_ = 0;
+    double meanVoices_ = 0.0;
+    size_t pos_ = 0;
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#if JUCE_LINUX
+ #include <fcntl.h>
+ #include <sys/resource.h>
+ #include <sys/time.h>
+ #include <unistd.h>
+#endif
+
+using namespace juce;
+
+/**
+ * Per-thread OS activity that can inflate a timed block without being plugin
+ * cost: page faults, context switches and time spent waiting on a run queue.
+ *
+ * Faults and switches come from getrusage(RUSAGE_THREAD); run-queue delay is
+ * the second field of /proc/thread-self/schedstat, which needs
+ * CONFIG_SCHEDSTATS (runQueueWaitNs stays 0 without it). Both describe the
+ * thread that called open(), so open and read on the measuring thread.
+ */
+class OsNoiseProbe {
+public:
+    struct Sample {
+        int64 minorFaults = 0;
+        int64 majorFaults = 0;
+        int64 voluntarySwitches = 0;
+        int64 involuntarySwitches = 0;
+        int64 runQueueWaitNs = 0;
+
+        Sample operator-(const Sample& o) const {
+            return { minorFaults - o.minorFaults, majorFaults - o.majorFaults,
+                     voluntarySwitches - o.voluntarySwitches,
+                     involuntarySwitches - o.involuntarySwitches,
+                     runQueueWaitNs - o.runQueueWaitNs };
+        }
+
+        Sample& operator+=(const Sample& o) {
+            minorFaults += o.minorFaults;
+            majorFaults += o.majorFaults;
+            voluntarySwitches += o.voluntarySwitches;
+            involuntarySwitches += o.involuntarySwitches;
+            runQueueWaitNs += o.runQueueWaitNs;
+            return *this;
+        }
+
+        /** Any fault or switch; run-queue wait alone only follows a switch. */
+        bool any() const {
+            return minorFaults + majorFaults + voluntarySwitches + involuntarySwitches > 0;
+        }
+    };
+
+    OsNoiseProbe() = default;
+    ~OsNoiseProbe() { close(); }
+
+    OsNoiseProbe(const OsNoiseProbe&) = delete;
+    OsNoiseProbe& operator=(const OsNoiseProbe&) = delete;
+
+    bool open(String& error) {
+       #if JUCE_LINUX
+        close();
+        schedstatFd_ = ::open("/proc/thread-self/schedstat", O_RDONLY | O_CLOEXEC);
+        isOpen_ = true;
+
+        rusage ru {};
+        if (getrusage(RUSAGE_THREAD, &ru) != 0) {
+            error = "getrusage(RUSAGE_THREAD) failed";
+            close();
+            return false;
+        }
+        return true;
+       #else
+        error = "per-thread OS noise accounting needs Linux (RUSAGE_THREAD)";
+        return false;
+       #endif
+    }
+
+    void close() {
+       #if JUCE_LINUX
+        if (schedstatFd_ >= 0) ::close(schedstatFd_);
+        schedstatFd_ = -1;
+       #endif
+        isOpen_ = false;
+    }
+
+    bool isOpen() const { return isOpen_; }
+    bool hasRunQueueWait() const { return schedstatFd_ >= 0; }
+
+    /** Two syscalls (getrusage + pread); call outside the timed region. */
+    inline Sample read() const {
+        Sample s;
+       #if JUCE_LINUX
+        rusage ru {};
+        if (getrusage(RUSAGE_THREAD, &ru) == 0) {
+            s.minorFaults = ru.ru_minflt;
+            s.majorFaults = ru.ru_majflt;
+            s.voluntarySwitches = ru.ru_nvcsw;
+            s.involuntarySwitches = ru.ru_nivcsw;
+        }
+
+        if (schedstatFd_ >= 0) {
+            // "<on-cpu ns> <run-queue wait ns> <timeslices>"
+            char buf[96];
+            const ssize_t n = pread(schedstatFd_, buf, sizeof(buf) - 1, 0);
+            if (n > 0) {
+                buf[n] = '\0';
+                char* end = nullptr;
+                std::strtoll(buf, &end, 10);
+                s.runQueueWaitNs = std::strtoll(end, nullptr, 10);
+            }
+        }
+       #endif
+        return s;
+    }
+
+private:
+    int schedstatFd_ = -1;
+    bool isOpen_ = false;
+};
+
+/**
+ * The N slowest iterations of a pass with the OS activity seen during each,
+ * so outliers can be attributed to faults or preemption rather than plugin cost.
+ */
+class OutlierLog {
+public:
+    struct Entry {
+        int iteration;
+        int64 ticks;
+        OsNoiseProbe::Sample os;
+    };
+
+    explicit OutlierLog(int capacity) : capacity_((size_t) jmax(0, capacity)) {
+        entries_.reserve(capacity_);
+    }
+
+    inline void offer(int iteration, int64 ticks, const OsNoiseProbe::Sample& os) {
+        if (capacity_ == 0) return;
+
+        if (entries_.size() < capacity_) {
+            entries_.push_back({ iteration, ticks, os });
+            std::push_heap(entries_.begin(), entries_.end(), fasterFirst);
+        } else if (ticks > entries_.front().ticks) {
+            std::pop_heap(entries_.begin(), entries_.end(), fasterFirst);
+            entries_.back() = { iteration, ticks, os };
+            std::push_heap(entries_.begin(), entries_.end(), fasterFirst);
+        }
+    }
+
+    /** Slowest first. */
+    std::vector<Entry> sorted() const {
+        auto out = entries_;
+        std::sort(out.begin(), out.end(), [](const Entry& a, const Entry& b) { return a.ticks > b.ticks; });
+        return out;
+    }
+
+private:
+    // Min-heap on ticks: the fastest kept outlier sits at the front
+    static bool fasterFirst(const Entry& a, const Entry& b) { return a.ticks > b.ticks; }
+
+    size_t capacity_;
+    std::vector<Entry> entries_;
+};
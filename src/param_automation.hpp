@@ -0,0 +1,136 @@
+#pragma once
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "plugin_params.hpp"
+
+using namespace juce;
+
+enum class AutomationShape { Ramp, Step, RandomWalk };
+
+/**
+ * Host-style parameter automation for the timed loop. Parameters are picked
+ * with PluginParameterManager's discovery; next() moves every selected
+ * parameter once every N blocks and is called before the block is timed,
+ * so only the plugin's reaction (smoothing, coefficient and filter
+ * recalculation) lands inside the timed region.
+ *
+ * JUCE delivers parameter changes to a hosted plugin at block boundaries,
+ * so automation faster than once per block cannot be expressed here.
+ */
+class ParameterAutomation {
+public:
+    static bool parseShape(const std::string& s, AutomationShape& out) {
+        if (s == "ramp") out = AutomationShape::Ramp;
+        else if (s == "step") out = AutomationShape::Step;
+        else if (s == "random") out = AutomationShape::RandomWalk;
+        else return false;
+        return true;
+    }
+
+    /**
+     * selectors: "all" for every automatable, non-meta parameter, or
+     * parameter indices, IDs or names (case-insensitive).
+     * periodBlocks is the length of one ramp up and down, in blocks
+     * whatever everyBlocks is.
+     */
+    ParameterAutomation(AudioPluginInstance& plugin, const std::vector<std::string>& selectors,
+                        AutomationShape shape, int everyBlocks, int periodBlocks)
+        : shape_(shape), every_(jmax(1, everyBlocks)), period_(jmax(2, periodBlocks))
+    {
+        auto& params = plugin.getParameters();
+        const auto infos = PluginParameterManager::queryParameters(plugin);
+        const bool all = selectors.size() == 1 && selectors[0] == "all";
+
+        for (const auto& info : infos) {
+            auto* param = info.index < params.size() ? params[info.index] : nullptr;
+            if (param == nullptr) continue;
+
+            bool selected = all && info.isAutomatable && ! info.isMetaParameter;
+            for (const auto& sel : selectors) {
+                const String s(sel);
+                if ((s.containsOnly("0123456789") && s.getIntValue() == info.index)
+                    || s.equalsIgnoreCase(info.id) || s.equalsIgnoreCase(info.name))
+                    selected = true;
+            }
+
+            if (selected)
+                lanes_.push_back({ param, info.name, param->getValue(), 0.0f });
+        }
+    }
+
+    bool empty() const { return lanes_.empty(); }
+    size_t size() const { return lanes_.size(); }
+
+    String describe() const {
+        StringArray names;
+        for (const auto& l : lanes_)
+            names.add(l.name);
+        return names.joinIntoString(", ");
+    }
+
+    /** Back to the start of the curve, with the random walk re-seeded. */
+    void rewind() {
+        block_ = 0;
+        rng_.setSeed(4242);
+        for (auto& l : lanes_)
+            l.walk = l.initial;
+    }
+
+    /** Advance one block; every N blocks all lanes move. Returns true when they did. */
+    bool next() {
+        const int b = block_++;
+        if (b % every_ != 0) return false;
+
+        const int step = b / every_;
+        for (size_t i = 0; i < lanes_.size(); ++i) {
+            auto& l = lanes_[i];
+            float v = 0.0f;
+            switch (shape_) {
+                case AutomationShape::Ramp: {
+                    // The period counts blocks, not updates, so --automation-every
+                    // samples the curve more coarsely without stretching it.
+                    // Lanes are phase-shifted so they do not all move in lockstep
+                    const int shift = (int) i * period_ / jmax(1, (int) lanes_.size());
+                    const int pos = (b + shift) % period_;
+                    const float x = (float) pos / (float) (period_ / 2);
+                    v = x <= 1.0f ? x : 2.0f - x;
+                    break;
+                }
+                case AutomationShape::Step:
+                    // Neighbouring lanes step in opposite directions
+                    v = ((step + (int) i) % 2 == 0) ? 0.25f : 0.75f;
+                    break;
+                case AutomationShape::RandomWalk:
+                    l.walk = jlimit(0.0f, 1.0f, l.walk + (rng_.nextFloat() - 0.5f) * 0.1f);
+                    v = l.walk;
+                    break;
+            }
+            l.param->setValue(v);
+        }
+        return true;
+    }
+
+    /** Put every automated parameter back where it was before the pass. */
+    void restore() {
+        for (auto& l : lanes_)
+            l.param->setValue(l.initial);
+    }
+
+private:
+    struct Lane {
+        AudioProcessorParameter* param;
+        String name;
+        float initial;
+        float walk;
+    };
+
+    AutomationShape shape_;
+    int every_;
+    int period_;
+    std::vector<Lane> lanes_;
+    int block_ = 0;
+    Random rng_ { 4242 };
+};
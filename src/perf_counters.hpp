@@ -0,0 +1,197 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <array>
+#include <string>
+#include <cerrno>
+#include <cstring>
+
+#if JUCE_LINUX
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+using namespace juce;
+
+/**
+ * Grouped hardware performance counters for the calling thread.
+ *
+ * All events are opened as one perf_event group, so a single read() returns a
+ * consistent snapshot of every counter. Counting is user-space only, which is
+ * what perf_event_paranoid=2 (the common distro default) still permits.
+ *
+ * Events the PMU cannot provide are skipped individually; if the whole group
+ * cannot be scheduled (too few counters, e.g. with the NMI watchdog holding
+ * one), events are dropped from the end until it fits.
+ */
+class PerfCounterGroup {
+public:
+    enum Counter {
+        Cycles,
+        Instructions,
+        BranchMisses,
+        L1dMisses,
+        LlcMisses,
+        DtlbMisses,
+        NumCounters
+    };
+
+    using Snapshot = std::array<uint64, NumCounters>;
+
+    PerfCounterGroup() { fds_.fill(-1); }
+    ~PerfCounterGroup() { close(); }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    /**
+     * Open and enable the group on the calling thread. On failure the error
+     * explains why (including the current perf_event_paranoid level).
+     */
+    bool open(String& error) {
+       #if JUCE_LINUX
+        close();
+
+        for (int c = 0; c < NumCounters; ++c) {
+            const int groupFd = fds_[Cycles];
+            if (c != Cycles && groupFd < 0) break;
+
+            fds_[(size_t) c] = openEvent((Counter) c, groupFd);
+
+            if (c == Cycles && fds_[Cycles] < 0) {
+                error = String("perf_event_open failed: ") + std::strerror(errno)
+                      + " (perf_event_paranoid=" + readParanoidLevel()
+                      + "; counters need <= 2, or CAP_PERFMON)";
+                return false;
+            }
+        }
+
+        // Drop events from the end until the group actually gets scheduled
+        for (;;) {
+            ioctl(fds_[Cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds_[Cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+            ReadBuffer buf {};
+            if (readGroup(buf) && buf.timeRunning > 0)
+                break;
+
+            int last = NumCounters - 1;
+            while (last > Cycles && fds_[(size_t) last] < 0) --last;
+
+            if (last == Cycles) {
+                error = "perf counter group could not be scheduled on the PMU";
+                close();
+                return false;
+            }
+
+            ioctl(fds_[Cycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            ::close(fds_[(size_t) last]);
+            fds_[(size_t) last] = -1;
+        }
+
+        return true;
+       #else
+        error = "hardware counters need perf_event_open (Linux only)";
+        return false;
+       #endif
+    }
+
+    void close() {
+       #if JUCE_LINUX
+        for (auto& fd : fds_) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+       #endif
+    }
+
+    bool isOpen() const { return fds_[Cycles] >= 0; }
+
+    bool isAvailable(Counter c) const { return fds_[(size_t) c] >= 0; }
+
+    /** One read() syscall; unavailable counters read as 0. */
+    inline void read(Snapshot& out) const {
+        out.fill(0);
+       #if JUCE_LINUX
+        ReadBuffer buf {};
+        if (!readGroup(buf)) return;
+
+        // Group values come back in creation order, skipping unopened events
+        uint64 slot = 0;
+        for (size_t c = 0; c < (size_t) NumCounters && slot < buf.nr; ++c)
+            if (fds_[c] >= 0)
+                out[c] = buf.values[slot++];
+       #endif
+    }
+
+    static const char* counterName(Counter c) {
+        switch (c) {
+            case Cycles:       return "cycles";
+            case Instructions: return "instructions";
+            case BranchMisses: return "branch-misses";
+            case L1dMisses:    return "L1-dcache-load-misses";
+            case LlcMisses:    return "LLC-load-misses";
+            case DtlbMisses:   return "dTLB-load-misses";
+            case NumCounters:  break;
+        }
+        return "unknown";
+    }
+
+private:
+    struct ReadBuffer {
+        uint64 nr;
+        uint64 timeEnabled;
+        uint64 timeRunning;
+        uint64 values[NumCounters];
+    };
+
+   #if JUCE_LINUX
+    static int openEvent(Counter c, int groupFd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = groupFd < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP
+                         | PERF_FORMAT_TOTAL_TIME_ENABLED
+                         | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        auto cacheMiss = [](uint64 cache) {
+            return cache
+                 | ((uint64) PERF_COUNT_HW_CACHE_OP_READ << 8)
+                 | ((uint64) PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+
+        switch (c) {
+            case Cycles:       attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case Instructions: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case BranchMisses: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            case L1dMisses:    attr.type = PERF_TYPE_HW_CACHE; attr.config = cacheMiss(PERF_COUNT_HW_CACHE_L1D); break;
+            case LlcMisses:    attr.type = PERF_TYPE_HW_CACHE; attr.config = cacheMiss(PERF_COUNT_HW_CACHE_LL); break;
+            case DtlbMisses:   attr.type = PERF_TYPE_HW_CACHE; attr.config = cacheMiss(PERF_COUNT_HW_CACHE_DTLB); break;
+            case NumCounters:  return -1;
+        }
+
+        return (int) syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1 /* any cpu */, groupFd, 0);
+    }
+
+    static String readParanoidLevel() {
+        return File("/proc/sys/kernel/perf_event_paranoid").loadFileAsString().trim();
+    }
+   #endif
+
+    inline bool readGroup(ReadBuffer& buf) const {
+       #if JUCE_LINUX
+        if (fds_[Cycles] < 0) return false;
+        const ssize_t n = ::read(fds_[Cycles], &buf, sizeof(buf));
+        return n >= (ssize_t) (3 * sizeof(uint64));
+       #else
+        ignoreUnused(buf);
+        return false;
+       #endif
+    }
+
+    std::array<int, NumCounters> fds_;
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#if JUCE_LINUX
+ #include <time.h>
+ #include <cerrno>
+#endif
+
+using namespace juce;
+
+/**
+ * How the paced loop waits for each period deadline.
+ *   None   - back-to-back processBlock calls (classic benchmark loop)
+ *   Sleep  - absolute-deadline sleep, like a driver-woken audio thread
+ *   Spin   - busy-wait; lowest jitter, keeps the core hot
+ *   Hybrid - sleep until shortly before the deadline, then spin
+ */
+enum class PacingMode {
+    None,
+    Sleep,
+    Spin,
+    Hybrid
+};
+
+/**
+ * Emulates an audio device that fires a callback once per period.
+ *
+ * Deadlines are absolute (start + k * period) so lateness never accumulates.
+ * A block that completes after the following deadline is counted as an xrun,
+ * and the periods it overran are skipped, as a real device would drop them.
+ * All times are steady_clock nanoseconds (CLOCK_MONOTONIC on Linux).
+ */
+class PeriodPacer {
+public:
+    PeriodPacer(PacingMode mode, double periodSeconds)
+        : mode_(mode), periodNs_((int64) (periodSeconds * 1.0e9)) {}
+
+    static int64 nowNs() {
+        return (int64) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** First callback fires one period from now. */
+    void start() {
+        deadlineNs_ = nowNs() + periodNs_;
+        xruns_ = 0;
+    }
+
+    /**
+     * Block until the current period deadline. Returns the wake-up jitter
+     * (how late the thread actually resumed) in nanoseconds.
+     */
+    int64 waitForDeadline() {
+        switch (mode_) {
+            case PacingMode::None:
+                return 0;
+            case PacingMode::Sleep:
+                sleepUntil(deadlineNs_);
+                break;
+            case PacingMode::Spin:
+                spinUntil(deadlineNs_);
+                break;
+            case PacingMode::Hybrid:
+                sleepUntil(deadlineNs_ - hybridSpinMarginNs);
+                spinUntil(deadlineNs_);
+                break;
+        }
+
+        const int64 late = nowNs() - deadlineNs_;
+        return late > 0 ? late : 0;
+    }
+
+    /**
+     * Call once the block is processed. Returns true if it finished after the
+     * next period began (an xrun), and moves on to the next deadline.
+     */
+    bool finishPeriod() {
+        const int64 now = nowNs();
+        deadlineNs_ += periodNs_;
+
+        if (now <= deadlineNs_)
+            return false;
+
+        ++xruns_;
+        const int64 missed = (now - deadlineNs_) / periodNs_ + 1;
+        deadlineNs_ += missed * periodNs_;
+        return true;
+    }
+
+    uint64 xruns() const { return xruns_; }
+
+    static const char* modeName(PacingMode m) {
+        switch (m) {
+            case PacingMode::None:   return "off";
+            case PacingMode::Sleep:  return "sleep";
+            case PacingMode::Spin:   return "spin";
+            case PacingMode::Hybrid: return "hybrid";
+        }
+        return "off";
+    }
+
+    static bool parseMode(const std::string& name, PacingMode& out) {
+        if (name == "off")    { out = PacingMode::None;   return true; }
+        if (name == "sleep")  { out = PacingMode::Sleep;  return true; }
+        if (name == "spin")   { out = PacingMode::Spin;   return true; }
+        if (name == "hybrid") { out = PacingMode::Hybrid; return true; }
+        return false;
+    }
+
+    static constexpr int64 hybridSpinMarginNs = 200000; // 200 us
+
+private:
+    static void sleepUntil(int64 deadlineNs) {
+       #if JUCE_LINUX
+        timespec ts;
+        ts.tv_sec = (time_t) (deadlineNs / 1000000000LL);
+        ts.tv_nsec = (long) (deadlineNs % 1000000000LL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+       #else
+        using clock = std::chrono::steady_clock;
+        std::this_thread::sleep_until(clock::time_point(
+            std::chrono::duration_cast<clock::duration>(std::chrono::nanoseconds(deadlineNs))));
+       #endif
+    }
+
+    static void spinUntil(int64 deadlineNs) {
+        while (nowNs() < deadlineNs) {}
+    }
+
+    PacingMode mode_;
+    int64 periodNs_;
+    int64 deadlineNs_ = 0;
+    uint64 xruns_ = 0;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <cstring>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <unistd.h>
+#endif
+
+using namespace juce;
+
+/**
+ * Phase markers for a supervising process (plugperf-batch). With
+ * --phase-fd N each phase change writes one line, the phase name, to that
+ * descriptor: scan, load, prepare, process. The supervisor runs a watchdog
+ * per phase, and when the worker crashes or hangs the last line names the
+ * phase it died in.
+ *
+ * prepare/process repeat for every buffer size, so each prepareToPlay and
+ * each measurement gets its own watchdog period. One write() per marker,
+ * no buffering, so a marker is out before the call that may never return.
+ */
+struct PhaseReport {
+    /** Report to this descriptor from now on; -1 turns reporting off. */
+    static void open(int fd) { descriptor() = fd; }
+
+    static void enter(const char* phase) {
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        const int fd = descriptor();
+        if (fd < 0) return;
+
+        char line[32];
+        const size_t n = jmin(std::strlen(phase), sizeof(line) - 1);
+        std::memcpy(line, phase, n);
+        line[n] = '\n';
+        ssize_t rc = ::write(fd, line, n + 1);
+        ignoreUnused(rc);
+       #else
+        ignoreUnused(phase);
+       #endif
+    }
+
+private:
+    static int& descriptor() {
+        static int fd = -1;
+        return fd;
+    }
+};
@@ -0,0 +1,258 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace juce;
+
+/**
+ * Plugin loading shared by the single-plugin benchmark and the multi-instance
+ * modes. All functions must be called on the message thread.
+ */
+struct PluginHost {
+    /**
+     * Channel layout from a --channels entry: a count ("1", "2", "12"; 1 and 2
+     * are mono and stereo, anything else discrete), a named layout ("lcr",
+     * "quad", "5.0", "5.1", "6.1", "7.0", "7.1", "5.1.2", "5.1.4", "7.1.2",
+     * "7.1.4", "9.1.6") or an ambisonic order ("ambi1" .. "ambi7").
+     */
+    static bool parseChannelLayout(const String& spec, AudioChannelSet& out)
+    {
+        const String s = spec.trim().toLowerCase();
+
+        if (s.isNotEmpty() && s.containsOnly("0123456789"))
+        {
+            const int n = s.getIntValue();
+            if (n <= 0) return false;
+            out = n == 1 ? AudioChannelSet::mono() : n == 2 ? AudioChannelSet::stereo()
+                                                            : AudioChannelSet::discreteChannels(n);
+            return true;
+        }
+
+        if (s.startsWith("ambi"))
+        {
+            const String order = s.fromFirstOccurrenceOf("ambi", false, false);
+            if (order.isEmpty() || ! order.containsOnly("0123456789")
+                || order.getIntValue() < 1 || order.getIntValue() > 7)
+                return false;
+            out = AudioChannelSet::ambisonic(order.getIntValue());
+            return true;
+        }
+
+        for (const auto& named : namedLayouts())
+            if (s == named.first) { out = named.second; return true; }
+        return false;
+    }
+
+    /** Short name for CSV output: the --channels spelling where there is one. */
+    static String channelLayoutName(const AudioChannelSet& set)
+    {
+        if (set == AudioChannelSet::mono()) return "mono";
+        if (set == AudioChannelSet::stereo()) return "stereo";
+        for (const auto& named : namedLayouts())
+            if (set == named.second) return named.first;
+        for (int order = 1; order <= 7; ++order)
+            if (set == AudioChannelSet::ambisonic(order)) return "ambi" + String(order);
+        if (set.isDiscreteLayout()) return "discrete" + String(set.size());
+        return set.getDescription();
+    }
+
+    /**
+     * Layouts to offer in turn for a request: the request itself, the
+     * canonical set for its channel count, discrete channels, then every
+     * other named set JUCE knows with that many channels. Plugins often only
+     * accept one spelling of a count (e.g. 5.1 but not discrete 6).
+     */
+    static std::vector<AudioChannelSet> channelLayoutCandidates(const AudioChannelSet& requested)
+    {
+        std::vector<AudioChannelSet> out;
+        auto add = [&out](const AudioChannelSet& set) {
+            if (std::find(out.begin(), out.end(), set) == out.end())
+                out.push_back(set);
+        };
+
+        const int n = requested.size();
+        add(requested);
+        add(AudioChannelSet::canonicalChannelSet(n));
+        add(AudioChannelSet::discreteChannels(n));
+        for (const auto& set : AudioChannelSet::channelSetsWithNumberOfChannels(n))
+            add(set);
+        return out;
+    }
+
+    static bool configureChannelLayout(AudioPluginInstance& proc,
+                                       int requestedChannels,
+                                       int& configuredChannels)
+    {
+        if (requestedChannels <= 0)
+            return false;
+
+        return configureChannelLayout(proc, requestedChannels == 1 ? AudioChannelSet::mono()
+                                            : requestedChannels == 2 ? AudioChannelSet::stereo()
+                                                                     : AudioChannelSet::canonicalChannelSet(requestedChannels),
+                                      configuredChannels);
+    }
+
+    /**
+     * Put the main input and output bus on the requested layout, falling back
+     * through channelLayoutCandidates() until the plugin accepts one with the
+     * same channel count. The layout that was granted is stored in granted.
+     */
+    static bool configureChannelLayout(AudioPluginInstance& proc,
+                                       const AudioChannelSet& requested,
+                                       int& configuredChannels,
+                                       AudioChannelSet* granted = nullptr)
+    {
+        const int requestedChannels = requested.size();
+        if (requestedChannels <= 0)
+            return false;
+
+        const int inputBusCount  = proc.getBusCount(true);
+        const int outputBusCount = proc.getBusCount(false);
+
+        for (const auto& desiredSet : channelLayoutCandidates(requested))
+        {
+            auto layout = proc.getBusesLayout();
+            bool layoutChanged = false;
+
+            if (outputBusCount > 0 && layout.outputBuses.getReference(0) != desiredSet)
+            {
+                layout.outputBuses.getReference(0) = desiredSet;
+                layoutChanged = true;
+            }
+
+            if (inputBusCount > 0 && layout.inputBuses.getReference(0) != desiredSet)
+            {
+                layout.inputBuses.getReference(0) = desiredSet;
+                layoutChanged = true;
+            }
+
+            if (layoutChanged && ! proc.setBusesLayout(layout))
+                continue;
+
+            const int actualInputs  = inputBusCount  > 0 ? proc.getChannelCountOfBus(true, 0)  : 0;
+            const int actualOutputs = outputBusCount > 0 ? proc.getChannelCountOfBus(false, 0) : 0;
+
+            if (outputBusCount > 0 && actualOutputs != requestedChannels)
+                continue;
+            if (inputBusCount > 0 && actualInputs != 0 && actualInputs != requestedChannels)
+                continue;
+
+            configuredChannels = requestedChannels;
+            if (granted != nullptr)
+                *granted = outputBusCount > 0 ? proc.getChannelLayoutOfBus(false, 0) : desiredSet;
+            if (desiredSet != requested)
+                std::cerr << "WARNING: Plugin rejected the " << channelLayoutName(requested)
+                          << " layout; using " << channelLayoutName(desiredSet) << " instead.\n";
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Enable or disable every auxiliary input bus (sidechains), leaving the
+     * main buses alone. An enabled bus gets its default layout, else the main
+     * input's layout, stereo or mono - the first the plugin accepts. Returns
+     * the channel count on auxiliary inputs afterwards; in the processBlock
+     * buffer they follow the main input's channels.
+     */
+    static int configureAuxInputs(AudioPluginInstance& proc, bool enable)
+    {
+        const int inputBusCount = proc.getBusCount(true);
+
+        for (int i = 1; i < inputBusCount; ++i)
+        {
+            auto* bus = proc.getBus(true, i);
+            if (bus == nullptr)
+                continue;
+
+            std::vector<AudioChannelSet> options { AudioChannelSet::disabled() };
+            if (enable)
+                options = { bus->getDefaultLayout(), proc.getChannelLayoutOfBus(true, 0),
+                            AudioChannelSet::stereo(), AudioChannelSet::mono() };
+
+            for (const auto& set : options)
+            {
+                if (enable && set.isDisabled())
+                    continue;
+                auto layout = proc.getBusesLayout();
+                if (layout.inputBuses.getReference(i) == set)
+                    break;
+                layout.inputBuses.getReference(i) = set;
+                if (proc.setBusesLayout(layout))
+                    break;
+            }
+        }
+
+        int auxChannels = 0;
+        for (int i = 1; i < inputBusCount; ++i)
+            auxChannels += proc.getChannelCountOfBus(true, i);
+        return auxChannels;
+    }
+
+    static void printInstantiationError(const String& err, const String& path)
+    {
+        std::cerr << "CreatePluginInstance failed for \n  "
+                  << path << "\nReason: " << err << "\n";
+    }
+
+    /**
+     * Create one more instance of an already scanned plugin, with the channel
+     * layout and processing precision applied. Returns nullptr (and reports
+     * why on stderr) on failure. prepareToPlay() is left to the caller.
+     * Double precision is only requested from plugins that support it; the
+     * others stay in single precision.
+     */
+    static std::unique_ptr<AudioPluginInstance> createConfiguredInstance(AudioPluginFormatManager& fm,
+                                                                         const PluginDescription& desc,
+                                                                         int channels,
+                                                                         bool useDouble)
+    {
+        String err;
+        std::unique_ptr<AudioPluginInstance> instance(fm.createPluginInstance(desc, 0, 0, err));
+
+        if (instance == nullptr)
+        {
+            printInstantiationError(err, desc.fileOrIdentifier);
+            return nullptr;
+        }
+
+        int configured = channels;
+        if (! configureChannelLayout(*instance, channels, configured))
+        {
+            std::cerr << "Unable to configure plugin for " << channels << " channels.\n";
+            return nullptr;
+        }
+
+        const bool canDouble = useDouble && instance->supportsDoublePrecisionProcessing();
+        instance->setProcessingPrecision(canDouble ? AudioProcessor::doublePrecision
+                                                   : AudioProcessor::singlePrecision);
+        return instance;
+    }
+
+private:
+    static const std::vector<std::pair<String, AudioChannelSet>>& namedLayouts()
+    {
+        static const std::vector<std::pair<String, AudioChannelSet>> layouts {
+            { "lcr",   AudioChannelSet::createLCR() },
+            { "quad",  AudioChannelSet::quadraphonic() },
+            { "5.0",   AudioChannelSet::create5point0() },
+            { "5.1",   AudioChannelSet::create5point1() },
+            { "6.1",   AudioChannelSet::create6point1() },
+            { "7.0",   AudioChannelSet::create7point0() },
+            { "7.1",   AudioChannelSet::create7point1() },
+            { "5.1.2", AudioChannelSet::create5point1point2() },
+            { "5.1.4", AudioChannelSet::create5point1point4() },
+            { "7.1.2", AudioChannelSet::create7point1point2() },
+            { "7.1.4", AudioChannelSet::create7point1point4() },
+            { "9.1.6", AudioChannelSet::create9point1point6() },
+        };
+        return layouts;
+    }
+};
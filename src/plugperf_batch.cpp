@@ -0,0 +1,320 @@
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "csv.hpp"
+#include "worker_pool.hpp"
+
+using namespace juce;
+
+void printUsage() {
+    std::cout << R"(
+plugperf-batch - Crash-isolated batch runner for plugperf
+
+Runs plugperf once per plugin, each in its own worker process, several at a
+time on disjoint cores. Workers report their phase (scan, load, prepare,
+process); a worker that crashes, or stays in one phase past its timeout, is
+recorded as a failure and the batch goes on.
+
+Usage:
+  plugperf-batch [options] [-- plugperf options]
+
+Options:
+  --plugin PATH            Plugin to test (repeatable)
+  --plugin-dir DIR         Test every .vst3 in DIR (repeatable; default: the
+                           system VST3 folders when no --plugin is given)
+  --output-dir DIR         Results folder (default: ./plugin_results)
+  --plugperf PATH          plugperf binary (default: next to plugperf-batch)
+  --workers N              Concurrent workers (default: 1)
+  --cores-per-worker K     Cores pinned to each worker (default: 1)
+  --first-core C           Worker i gets cores C+i*K .. C+i*K+K-1, counted
+                           over the CPUs this process may run on (default: 0)
+  --no-pin                 Do not pin workers to cores
+  --scan-timeout S         Watchdog for start-up and scanning (default: 60)
+  --load-timeout S         Watchdog for instantiation (default: 60)
+  --prepare-timeout S      Watchdog for each prepareToPlay (default: 30)
+  --process-timeout S      Watchdog for each buffer size's run (default: 600)
+  --memory-limit-mb N      Address-space limit per worker (default: none)
+  -h, --help               Show this help message
+
+Everything after -- is passed to every plugperf run, e.g.
+  plugperf-batch --plugin-dir ~/.vst3 --workers 4 -- --buffers 64,256 --iterations 200
+A passed-through --pin-threads pins within the worker's own cores.
+
+Output (in --output-dir):
+  <plugin>.csv             plugperf's CSV for that plugin
+  <plugin>.log             its stdout and stderr
+  results.csv              every successful plugin's rows, one header
+  batch.csv                one status row per plugin (ok, timeout, crash, exit)
+
+)" << std::endl;
+}
+
+struct BatchArgs {
+    std::vector<std::string> plugins;
+    std::vector<std::string> pluginDirs;
+    std::string outputDir = "./plugin_results";
+    std::string plugperf;
+    WorkerPoolConfig pool;
+    std::vector<std::string> passthrough;
+    bool help = false;
+};
+
+bool parseArgs(int argc, char** argv, BatchArgs& args) {
+    auto seconds = [](const char* v) { return String(v).getDoubleValue(); };
+
+    for (int i = 1; i < argc; ++i) {
+        String arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--help" || arg == "-h") {
+            args.help = true;
+            return true;
+        } else if (arg == "--") {
+            for (++i; i < argc; ++i)
+                args.passthrough.push_back(argv[i]);
+        } else if (arg == "--plugin" && hasValue) {
+            args.plugins.push_back(argv[++i]);
+        } else if (arg == "--plugin-dir" && hasValue) {
+            args.pluginDirs.push_back(argv[++i]);
+        } else if (arg == "--output-dir" && hasValue) {
+            args.outputDir = argv[++i];
+        } else if (arg == "--plugperf" && hasValue) {
+            args.plugperf = argv[++i];
+        } else if (arg == "--workers" && hasValue) {
+            args.pool.workers = String(argv[++i]).getIntValue();
+        } else if (arg == "--cores-per-worker" && hasValue) {
+            args.pool.coresPerWorker = String(argv[++i]).getIntValue();
+        } else if (arg == "--first-core" && hasValue) {
+            args.pool.firstCore = String(argv[++i]).getIntValue();
+        } else if (arg == "--no-pin") {
+            args.pool.pin = false;
+        } else if (arg == "--scan-timeout" && hasValue) {
+            args.pool.timeouts.scan = seconds(argv[++i]);
+        } else if (arg == "--load-timeout" && hasValue) {
+            args.pool.timeouts.load = seconds(argv[++i]);
+        } else if (arg == "--prepare-timeout" && hasValue) {
+            args.pool.timeouts.prepare = seconds(argv[++i]);
+        } else if (arg == "--process-timeout" && hasValue) {
+            args.pool.timeouts.process = seconds(argv[++i]);
+        } else if (arg == "--memory-limit-mb" && hasValue) {
+            args.pool.memoryLimitMb = String(argv[++i]).getIntValue();
+        } else {
+            std::cerr << "ERROR: Unknown or incomplete option: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (args.pool.workers < 1 || args.pool.coresPerWorker < 1 || args.pool.firstCore < 0) {
+        std::cerr << "ERROR: --workers and --cores-per-worker must be >= 1, --first-core >= 0\n";
+        return false;
+    }
+    const auto& t = args.pool.timeouts;
+    if (t.scan <= 0 || t.load <= 0 || t.prepare <= 0 || t.process <= 0) {
+        std::cerr << "ERROR: Timeouts must be > 0 seconds\n";
+        return false;
+    }
+    if (args.pool.memoryLimitMb < 0) {
+        std::cerr << "ERROR: --memory-limit-mb must be >= 0\n";
+        return false;
+    }
+
+    // The runner owns the plugin, the output file and the phase pipe of every worker
+    for (const auto& p : args.passthrough) {
+        if (p == "--plugin" || p == "--chain" || p == "--session" || p == "--out" || p == "--phase-fd") {
+            std::cerr << "ERROR: " << p << " is set by plugperf-batch and cannot be passed through\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Default VST3 folders of the platform. */
+static StringArray systemPluginDirs() {
+    const auto home = File::getSpecialLocation(File::userHomeDirectory);
+    StringArray dirs;
+   #if JUCE_MAC
+    dirs.add("/Library/Audio/Plug-Ins/VST3");
+    dirs.add(home.getChildFile("Library/Audio/Plug-Ins/VST3").getFullPathName());
+   #else
+    dirs.add(home.getChildFile(".vst3").getFullPathName());
+    dirs.add("/usr/lib/vst3");
+    dirs.add("/usr/local/lib/vst3");
+   #endif
+    return dirs;
+}
+
+/** Every .vst3 (bundle folder or file) directly inside dir, sorted. */
+static std::vector<std::string> findPlugins(const File& dir) {
+    std::vector<std::string> out;
+    for (const auto& f : dir.findChildFiles(File::findFilesAndDirectories, false, "*.vst3"))
+        out.push_back(f.getFullPathName().toStdString());
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+/** File-name stem safe for the output folder, unique within the batch. */
+static std::string safeName(const std::string& pluginPath, std::set<std::string>& used) {
+    String stem = File(pluginPath).getFileNameWithoutExtension();
+    String safe;
+    for (int i = 0; i < stem.length(); ++i) {
+        const auto c = stem[i];
+        safe += (CharacterFunctions::isLetterOrDigit(c) || c == '-' || c == '_') ? String::charToString(c) : "_";
+    }
+
+    std::string name = safe.toStdString();
+    for (int n = 2; ! used.insert(name).second; ++n)
+        name = safe.toStdString() + "_" + std::to_string(n);
+    return name;
+}
+
+int main(int argc, char** argv) {
+    BatchArgs args;
+    if (!parseArgs(argc, argv, args)) return 1;
+    if (args.help) {
+        printUsage();
+        return 0;
+    }
+
+    const File plugperf = args.plugperf.empty()
+        ? File::getSpecialLocation(File::currentExecutableFile).getSiblingFile("plugperf")
+        : File::getCurrentWorkingDirectory().getChildFile(args.plugperf);
+    if (!plugperf.existsAsFile()) {
+        std::cerr << "ERROR: plugperf binary not found: " << plugperf.getFullPathName() << "\n";
+        return 2;
+    }
+
+    // Plugins: explicit ones first, then every folder, in order
+    std::vector<std::string> plugins = args.plugins;
+    StringArray dirs;
+    for (const auto& d : args.pluginDirs) dirs.add(d);
+    if (args.plugins.empty() && args.pluginDirs.empty()) dirs = systemPluginDirs();
+    for (const auto& d : dirs) {
+        const File dir = File::getCurrentWorkingDirectory().getChildFile(d);
+        if (!dir.isDirectory()) {
+            if (!args.pluginDirs.empty()) std::cerr << "WARNING: Not a folder: " << d << "\n";
+            continue;
+        }
+        for (const auto& p : findPlugins(dir)) plugins.push_back(p);
+    }
+    if (plugins.empty()) {
+        std::cerr << "ERROR: No plugins to test\n";
+        return 2;
+    }
+
+    const int cpus = RealtimeScheduling::allowedCpuCount();
+    const int lastCore = args.pool.firstCore + args.pool.workers * args.pool.coresPerWorker - 1;
+    if (args.pool.pin && lastCore >= cpus) {
+        std::cerr << "WARNING: Workers need " << lastCore + 1 << " cores but this process may run on only "
+                  << cpus << "; running unpinned.\n";
+        args.pool.pin = false;
+    }
+   #if ! JUCE_LINUX
+    if (args.pool.pin) {
+        std::cerr << "WARNING: Core pinning is only available on Linux; workers run unpinned.\n";
+        args.pool.pin = false;
+    }
+   #endif
+
+    const File outDir = File::getCurrentWorkingDirectory().getChildFile(args.outputDir);
+    if (!outDir.createDirectory()) {
+        std::cerr << "ERROR: Cannot create output folder: " << outDir.getFullPathName() << "\n";
+        return 2;
+    }
+
+    std::vector<BatchJob> jobs;
+    std::map<std::string, std::pair<File, File>> files; // plugin path -> CSV, log
+    std::set<std::string> usedNames;
+    for (const auto& p : plugins) {
+        const auto name = safeName(p, usedNames);
+        const File csv = outDir.getChildFile(String(name) + ".csv");
+        const File log = outDir.getChildFile(String(name) + ".log");
+        csv.deleteFile();
+
+        BatchJob job;
+        job.pluginPath = p;
+        job.logPath = log.getFullPathName().toStdString();
+        job.argv = { plugperf.getFullPathName().toStdString(), "--plugin", p,
+                     "--out", csv.getFullPathName().toStdString(),
+                     "--phase-fd", std::to_string(WorkerPool::kPhaseFd) };
+        job.argv.insert(job.argv.end(), args.passthrough.begin(), args.passthrough.end());
+        jobs.push_back(job);
+        files[p] = { csv, log };
+    }
+
+    CsvSink batch;
+    if (!batch.open(outDir.getChildFile("batch.csv").getFullPathName().toStdString())) {
+        std::cerr << "ERROR: Cannot write batch.csv in " << outDir.getFullPathName() << "\n";
+        return 2;
+    }
+    batch.batchHeader();
+    std::ofstream merged(outDir.getChildFile("results.csv").getFullPathName().toStdString(), std::ios::trunc);
+    std::string mergedHeader;
+
+    std::cerr << "Testing " << plugins.size() << " plugins with " << args.pool.workers << " worker"
+              << (args.pool.workers == 1 ? "" : "s") << (args.pool.pin ? "" : " (unpinned)")
+              << "; results in " << outDir.getFullPathName() << "\n";
+
+    int done = 0, failed = 0;
+    auto onDone = [&](const BatchOutcome& o) {
+        const auto& [csv, logFile] = files[o.pluginPath];
+        std::string status = o.status;
+
+        // Rows of a clean run go into results.csv; a run that wrote none is a failure too
+        int rows = 0;
+        if (status == "ok") {
+            StringArray lines;
+            lines.addLines(csv.loadFileAsString().trimEnd());
+            rows = jmax(0, lines.size() - 1);
+            if (rows == 0) {
+                status = "no_output";
+            } else if (mergedHeader.empty() || lines[0].toStdString() == mergedHeader) {
+                if (mergedHeader.empty()) {
+                    mergedHeader = lines[0].toStdString();
+                    merged << mergedHeader << "\n";
+                }
+                for (int i = 1; i < lines.size(); ++i)
+                    merged << lines[i] << "\n";
+                merged.flush();
+            } else {
+                std::cerr << "WARNING: " << o.pluginPath << " wrote a different CSV schema; left out of results.csv\n";
+            }
+        }
+
+        auto phaseSec = [&](const char* phase) {
+            const auto it = o.phaseSec.find(phase);
+            return it == o.phaseSec.end() ? std::string() : String(it->second, 3).toStdString();
+        };
+        batch.row({ o.pluginPath, status, status == "ok" ? std::string() : o.phase,
+                    o.signal != 0 ? std::to_string(o.signal) : std::string(),
+                    o.exitCode != 0 ? std::to_string(o.exitCode) : std::string(),
+                    std::to_string(o.worker), o.cpus, String(o.wallSec, 3).toStdString(),
+                    phaseSec("start"), phaseSec("scan"), phaseSec("load"), phaseSec("prepare"), phaseSec("process"),
+                    std::to_string(rows), status == "ok" ? csv.getFullPathName().toStdString() : std::string(),
+                    logFile.getFullPathName().toStdString(), o.message });
+        batch.out->flush();
+
+        ++done;
+        if (status != "ok") ++failed;
+        std::cerr << "[" << done << "/" << plugins.size() << "] " << File(o.pluginPath).getFileName() << ": " << status;
+        if (status == "ok")
+            std::cerr << " (" << rows << " rows, " << String(o.wallSec, 1) << " s)";
+        else if (status != "no_output")
+            std::cerr << " in " << o.phase << (o.message.empty() ? "" : " - " + o.message);
+        std::cerr << "\n";
+    };
+
+    WorkerPool pool(args.pool);
+    pool.run(jobs, onDone);
+
+    std::cerr << "Done: " << done - failed << " ok, " << failed << " failed";
+    if (done < (int) plugins.size())
+        std::cerr << ", " << plugins.size() - (size_t) done << " not run (interrupted)";
+    std::cerr << "\n";
+    return failed == 0 && done == (int) plugins.size() ? 0 : 1;
+}
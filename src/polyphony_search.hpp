@@ -0,0 +1,250 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "rt_scheduling.hpp"
+#include "block_timer.hpp"
+#include "latency_histogram.hpp"
+#include "period_pacer.hpp"
+#include "phase_report.hpp"
+
+using namespace juce;
+
+struct PolyphonyConfig {
+    AudioPluginInstance* plugin = nullptr;  // configured, unprepared; prepared per block size here
+    int blockSize = 0;
+    int channels = 0;
+    double sampleRate = 0.0;
+    int warmupPeriods = 0;
+    int timedPeriods = 0;
+    bool useDoublePrecision = false;
+    bool nonRealtime = false;
+    SchedPolicy schedPolicy = SchedPolicy::None; // None or Fifo, calling thread, during the trials only
+    int rtPriority = 80;
+    TimerBackend timer = TimerBackend::Juce;
+    PacingMode pacing = PacingMode::None;
+    double targetMissRate = 0.001;   // a trial passes at or below this miss rate
+    int maxVoices = 256;             // search ceiling
+    int velocity = 100;
+};
+
+/** One fixed held-note count run of timedPeriods blocks. */
+struct PolyphonyTrial {
+    int voices = 0;
+    uint64 misses = 0;
+    double missRate = 0.0;
+    double meanBlock = 0.0, p99Block = 0.0, maxBlock = 0.0; // us
+    bool passed = false;
+};
+
+/** Search result for one block size. */
+struct PolyphonyResult {
+    int maxVoices = 0;        // most held notes that met the target (0 if even silence missed)
+    PolyphonyTrial atMax;     // the passing trial at maxVoices
+    PolyphonyTrial idle;      // no notes held
+    double perVoiceUs = 0.0;  // least-squares slope of the mean block time over the passing trials
+    int trials = 0;
+    bool capped = false;      // hit PolyphonyConfig::maxVoices without failing
+    std::string schedPolicy;
+};
+
+/**
+ * How many held notes of an instrument fit in the real-time budget.
+ *
+ * Each trial starts N notes at the first warmup block and holds them through
+ * the warmup and timed blocks, which get an empty MidiBuffer; a block is
+ * missed when processBlock takes longer than block / sr. The notes are then
+ * released and a second of silence is rendered so release tails do not leak
+ * into the next trial.
+ *
+ * N doubles from 1 until a trial exceeds the target miss rate and is then
+ * bisected between the last pass and the first failure. Notes are spread
+ * over kLowestNote..kHighestNote and, past that range, over further MIDI
+ * channels. Only what the preset keeps sounding is measured, so the patch
+ * should sustain (pads, organs) rather than decay within the timed blocks.
+ */
+class PolyphonySearch {
+public:
+    static constexpr int kLowestNote = 24, kHighestNote = 108;
+    static constexpr int kNotesPerChannel = kHighestNote - kLowestNote + 1;
+    static constexpr int kVoiceLimit = 16 * kNotesPerChannel;
+
+    explicit PolyphonySearch(const PolyphonyConfig& cfg) : cfg_(cfg) {}
+
+    PolyphonyResult measure()
+    {
+        PolyphonyResult result;
+
+        auto& plug = *cfg_.plugin;
+        plug.releaseResources();
+        plug.setNonRealtime(cfg_.nonRealtime);
+        PhaseReport::enter("prepare");
+        plug.prepareToPlay(cfg_.sampleRate, cfg_.blockSize);
+        PhaseReport::enter("process");
+
+        // FIFO covers the trials only; the calling thread gets its policy back before releaseResources()
+        auto restoreScheduling = std::make_unique<ScopedSchedulingState>();
+        String error;
+        if (cfg_.schedPolicy == SchedPolicy::Fifo && ! RealtimeScheduling::applyFifo(cfg_.rtPriority, error))
+            std::cerr << "WARNING: " << error << "\n";
+        result.schedPolicy = RealtimeScheduling::describeCurrentThread();
+
+        const int ceiling = jmin(cfg_.maxVoices, kVoiceLimit);
+        const String tag = "[polyphony block=" + String(cfg_.blockSize) + "]";
+        std::vector<PolyphonyTrial> passed;
+
+        auto trial = [&](int voices) {
+            PolyphonyTrial t = cfg_.useDoublePrecision ? runTrial<double>(voices) : runTrial<float>(voices);
+            ++result.trials;
+            std::cerr << tag << " voices=" << voices << ": miss rate " << t.missRate
+                      << ", mean " << t.meanBlock << "us, max " << t.maxBlock << "us"
+                      << (t.passed ? " (pass)" : " (fail)") << "\n";
+            if (t.passed) passed.push_back(t);
+            return t;
+        };
+
+        result.idle = trial(0);
+        if (! result.idle.passed) {
+            restoreScheduling.reset();
+            plug.releaseResources();
+            return result;
+        }
+
+        int lo = 0, hi = 0;  // lo passes (0 = silence only), hi fails (0 = none yet)
+        PolyphonyTrial best = result.idle;
+
+        for (int n = 1;; n = jmin(n * 2, ceiling))
+        {
+            const PolyphonyTrial t = trial(n);
+            if (! t.passed) { hi = n; break; }
+
+            lo = n;
+            best = t;
+            if (n == ceiling) { result.capped = true; break; }
+        }
+
+        while (hi - lo > 1)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            const PolyphonyTrial t = trial(mid);
+            if (t.passed) { lo = mid; best = t; }
+            else hi = mid;
+        }
+
+        restoreScheduling.reset();
+        plug.releaseResources();
+
+        result.maxVoices = lo;
+        result.atMax = best;
+        result.perVoiceUs = slope(passed);
+        return result;
+    }
+
+private:
+    /** Least-squares slope of mean block time over voice count. */
+    static double slope(const std::vector<PolyphonyTrial>& trials)
+    {
+        if (trials.size() < 2) return 0.0;
+
+        double sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (const auto& t : trials) {
+            sx += t.voices;
+            sy += t.meanBlock;
+            sxx += (double) t.voices * t.voices;
+            sxy += t.voices * t.meanBlock;
+        }
+        const double n = (double) trials.size();
+        const double den = n * sxx - sx * sx;
+        return den > 0.0 ? (n * sxy - sx * sy) / den : 0.0;
+    }
+
+    static void noteOns(MidiBuffer& midi, int voices, int velocity)
+    {
+        for (int v = 0; v < voices; ++v)
+            midi.addEvent(MidiMessage::noteOn(1 + v / kNotesPerChannel, kLowestNote + v % kNotesPerChannel,
+                                              (uint8) jlimit(1, 127, velocity)), 0);
+    }
+
+    static void noteOffs(MidiBuffer& midi, int voices)
+    {
+        for (int v = 0; v < voices; ++v)
+            midi.addEvent(MidiMessage::noteOff(1 + v / kNotesPerChannel, kLowestNote + v % kNotesPerChannel,
+                                               (uint8) 64), 0);
+    }
+
+    template <typename Sample>
+    PolyphonyTrial runTrial(int voices)
+    {
+        ScopedNoDenormals noDenormals;
+
+        auto& plug = *cfg_.plugin;
+        AudioBuffer<Sample> buf(cfg_.channels, cfg_.blockSize);
+        MidiBuffer midi;
+        midi.ensureSize((size_t) jmax(voices, 1) * 4);
+
+        const BlockTimer timer(cfg_.timer);
+        const double usPerTick = timer.ticksToMicros(1);
+        const double budget_us = (double) cfg_.blockSize * 1e6 / cfg_.sampleRate;
+        const int64 budgetTicks = (int64) (budget_us / usPerTick);
+
+        LatencyHistogram hist;
+        uint64 misses = 0;
+
+        PeriodPacer pacer(cfg_.pacing, (double) cfg_.blockSize / cfg_.sampleRate);
+
+        // The instrument writes its output over the buffer, so it is cleared
+        // untimed before every block instead of feeding back
+        auto block = [&]() -> int64 {
+            buf.clear();
+            const int64 t0 = timer.start();
+            plug.processBlock(buf, midi);
+            const int64 t1 = timer.stop();
+            midi.clear();
+            return t1 - t0;
+        };
+
+        noteOns(midi, voices, cfg_.velocity);
+        block();
+        for (int i = 1; i < cfg_.warmupPeriods; ++i)
+            block();
+
+        pacer.start();
+        for (int i = 0; i < cfg_.timedPeriods; ++i)
+        {
+            if (cfg_.pacing != PacingMode::None)
+                pacer.waitForDeadline();
+
+            const int64 elapsed = block();
+            hist.record(elapsed);
+            if (elapsed > budgetTicks) ++misses;
+
+            if (cfg_.pacing != PacingMode::None)
+                pacer.finishPeriod();
+        }
+
+        // Release and let the tails ring out before the next trial
+        noteOffs(midi, voices);
+        const int settle = jmax(1, (int) std::ceil(cfg_.sampleRate / cfg_.blockSize));
+        for (int i = 0; i < settle; ++i)
+            block();
+
+        PolyphonyTrial t;
+        t.voices = voices;
+        t.misses = misses;
+        t.missRate = cfg_.timedPeriods > 0 ? (double) misses / (double) cfg_.timedPeriods : 0.0;
+        t.meanBlock = hist.mean() * usPerTick;
+        t.p99Block = hist.valueAtQuantile(0.99) * usPerTick;
+        t.maxBlock = (double) hist.max() * usPerTick;
+        t.passed = t.missRate <= cfg_.targetMissRate;
+        return t;
+    }
+
+    PolyphonyConfig cfg_;
+};
@@ -0,0 +1,445 @@
+#include "rt_audit.hpp"
+
+#include <iostream>
+
+#if defined(__linux__) && defined(__GLIBC__)
+ #define PLUGPERF_RT_AUDIT_HOOKS 1
+#else
+ #define PLUGPERF_RT_AUDIT_HOOKS 0
+#endif
+
+#if PLUGPERF_RT_AUDIT_HOOKS
+ #include <atomic>
+ #include <cerrno>
+ #include <cstdio>
+ #include <cstring>
+ #include <limits>
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <linux/perf_event.h>
+ #include <pthread.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+
+// glibc's real allocator entry points; forwarding to them cannot recurse
+extern "C" {
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void* __libc_valloc(size_t);
+    void* __libc_pvalloc(size_t);
+    void __libc_free(void*);
+}
+
+namespace {
+
+constexpr int maxBacktraces = 16;
+constexpr int maxFrames = 32;
+
+struct Backtrace {
+    const char* call;
+    size_t bytes;
+    int depth;
+    void* frames[maxFrames];
+};
+
+// Everything is per thread: only the measuring thread ever sets active
+thread_local bool active = false;
+thread_local bool inHook = false;
+thread_local RtAudit::Counts counts;
+thread_local int backtraceLimit = 0;
+thread_local int backtraceCount = 0;
+thread_local Backtrace backtraces[maxBacktraces];
+thread_local int syscallFd = -1;
+thread_local int64 syscallBaseline = 0; // counted by our own read() calls
+thread_local uint64 syscallsAtBegin = 0;
+
+inline bool counting() { return active && ! inHook; }
+
+void capture(const char* call, size_t bytes)
+{
+    if (backtraceCount >= backtraceLimit)
+        return;
+
+    inHook = true;
+    auto& bt = backtraces[backtraceCount++];
+    bt.call = call;
+    bt.bytes = bytes;
+    bt.depth = backtrace(bt.frames, maxFrames);
+    ++counts.backtraces;
+    inHook = false;
+}
+
+inline void onAlloc(const char* call, size_t bytes)
+{
+    ++counts.allocs;
+    counts.allocBytes += bytes;
+    capture(call, bytes);
+}
+
+inline void onFree()
+{
+    ++counts.frees;
+    capture("free", 0);
+}
+
+inline void onLock(const char* call)
+{
+    ++counts.lockOps;
+    capture(call, 0);
+}
+
+inline void onCond(const char* call)
+{
+    ++counts.condOps;
+    capture(call, 0);
+}
+
+/**
+ * Next definition of a libpthread/libc symbol. Condition variables have two
+ * versions in glibc and plain dlsym() can hand back the old one, so the
+ * current version is asked for first.
+ */
+void* nextSymbol(const char* name, const char* version)
+{
+    void* fn = version != nullptr ? dlvsym(RTLD_NEXT, name, version) : nullptr;
+    return fn != nullptr ? fn : dlsym(RTLD_NEXT, name);
+}
+
+#if defined(__x86_64__)
+ constexpr const char* condVersion = "GLIBC_2.3.2";
+#else
+ constexpr const char* condVersion = nullptr;
+#endif
+
+template <typename Fn>
+struct Real {
+    const char* name;
+    const char* version;
+    std::atomic<Fn> fn { nullptr };
+
+    Fn get()
+    {
+        Fn f = fn.load(std::memory_order_acquire);
+        if (f == nullptr)
+        {
+            f = reinterpret_cast<Fn>(nextSymbol(name, version));
+            fn.store(f, std::memory_order_release);
+        }
+        return f;
+    }
+};
+
+using MutexFn = int (*)(pthread_mutex_t*);
+using RwFn = int (*)(pthread_rwlock_t*);
+using CondWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*);
+using CondTimedWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+using CondFn = int (*)(pthread_cond_t*);
+
+Real<MutexFn> realMutexLock { "pthread_mutex_lock", nullptr };
+Real<MutexFn> realMutexTrylock { "pthread_mutex_trylock", nullptr };
+Real<MutexFn> realMutexUnlock { "pthread_mutex_unlock", nullptr };
+Real<RwFn> realRwRdlock { "pthread_rwlock_rdlock", nullptr };
+Real<RwFn> realRwWrlock { "pthread_rwlock_wrlock", nullptr };
+Real<RwFn> realRwUnlock { "pthread_rwlock_unlock", nullptr };
+Real<CondWaitFn> realCondWait { "pthread_cond_wait", condVersion };
+Real<CondTimedWaitFn> realCondTimedWait { "pthread_cond_timedwait", condVersion };
+Real<CondFn> realCondSignal { "pthread_cond_signal", condVersion };
+Real<CondFn> realCondBroadcast { "pthread_cond_broadcast", condVersion };
+
+// Resolve everything before main() so the hooks never call dlsym() late
+__attribute__((constructor)) void resolveRealFunctions()
+{
+    realMutexLock.get(); realMutexTrylock.get(); realMutexUnlock.get();
+    realRwRdlock.get(); realRwWrlock.get(); realRwUnlock.get();
+    realCondWait.get(); realCondTimedWait.get(); realCondSignal.get(); realCondBroadcast.get();
+}
+
+uint64 readSyscalls()
+{
+    uint64 value = 0;
+    if (syscallFd >= 0 && ::read(syscallFd, &value, sizeof(value)) != (ssize_t) sizeof(value))
+        value = 0;
+    return value;
+}
+
+int readTracepointId()
+{
+    for (const char* path : { "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+                              "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id" })
+    {
+        if (FILE* f = std::fopen(path, "r"))
+        {
+            int id = -1;
+            if (std::fscanf(f, "%d", &id) != 1) id = -1;
+            std::fclose(f);
+            if (id >= 0) return id;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Interposed allocator. These symbols are exported (rt_audit.exports), so
+// plugins loaded later bind to these definitions too.
+// ---------------------------------------------------------------------------
+extern "C" {
+
+void* malloc(size_t size)
+{
+    if (counting()) onAlloc("malloc", size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+    if (counting()) onAlloc("calloc", n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    if (counting())
+    {
+        if (ptr == nullptr) onAlloc("realloc", size);
+        else if (size == 0) onFree();
+        else { ++counts.allocs; ++counts.frees; counts.allocBytes += size; capture("realloc", size); }
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void* reallocarray(void* ptr, size_t n, size_t size)
+{
+    if (size != 0 && n > std::numeric_limits<size_t>::max() / size)
+    {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(ptr, n * size);
+}
+
+void free(void* ptr)
+{
+    if (ptr != nullptr && counting()) onFree();
+    __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    if (counting()) onAlloc("memalign", size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    if (counting()) onAlloc("aligned_alloc", size);
+    return __libc_memalign(alignment, size);
+}
+
+void* valloc(size_t size)
+{
+    if (counting()) onAlloc("valloc", size);
+    return __libc_valloc(size);
+}
+
+void* pvalloc(size_t size)
+{
+    if (counting()) onAlloc("pvalloc", size);
+    return __libc_pvalloc(size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof(void*) != 0)
+        return EINVAL;
+
+    if (counting()) onAlloc("posix_memalign", size);
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr)
+        return ENOMEM;
+
+    *out = p;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Interposed locking
+// ---------------------------------------------------------------------------
+int pthread_mutex_lock(pthread_mutex_t* m)
+{
+    if (counting()) onLock("pthread_mutex_lock");
+    return realMutexLock.get()(m);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* m)
+{
+    if (counting()) onLock("pthread_mutex_trylock");
+    return realMutexTrylock.get()(m);
+}
+
+int pthread_mutex_unlock(pthread_mutex_t* m)
+{
+    if (counting()) onLock("pthread_mutex_unlock");
+    return realMutexUnlock.get()(m);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* l)
+{
+    if (counting()) onLock("pthread_rwlock_rdlock");
+    return realRwRdlock.get()(l);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* l)
+{
+    if (counting()) onLock("pthread_rwlock_wrlock");
+    return realRwWrlock.get()(l);
+}
+
+int pthread_rwlock_unlock(pthread_rwlock_t* l)
+{
+    if (counting()) onLock("pthread_rwlock_unlock");
+    return realRwUnlock.get()(l);
+}
+
+int pthread_cond_wait(pthread_cond_t* c, pthread_mutex_t* m)
+{
+    if (counting()) onCond("pthread_cond_wait");
+    return realCondWait.get()(c, m);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t)
+{
+    if (counting()) onCond("pthread_cond_timedwait");
+    return realCondTimedWait.get()(c, m, t);
+}
+
+int pthread_cond_signal(pthread_cond_t* c)
+{
+    if (counting()) onCond("pthread_cond_signal");
+    return realCondSignal.get()(c);
+}
+
+int pthread_cond_broadcast(pthread_cond_t* c)
+{
+    if (counting()) onCond("pthread_cond_broadcast");
+    return realCondBroadcast.get()(c);
+}
+
+} // extern "C"
+
+bool RtAudit::hooksAvailable() { return true; }
+
+bool RtAudit::openSyscallCounter(String& error)
+{
+    closeSyscallCounter();
+
+    const int id = readTracepointId();
+    if (id < 0)
+    {
+        error = "raw_syscalls:sys_enter tracepoint not found (is tracefs mounted?)";
+        return false;
+    }
+
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_TRACEPOINT;
+    attr.config = (uint64) id;
+
+    syscallFd = (int) syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1, -1, 0);
+    if (syscallFd < 0)
+    {
+        error = String("perf_event_open(raw_syscalls:sys_enter) failed: ") + std::strerror(errno)
+              + " (needs perf_event_paranoid <= -1 or CAP_PERFMON)";
+        return false;
+    }
+
+    // Our own read() in end() is counted too; measure that once and subtract it
+    int64 baseline = std::numeric_limits<int64>::max();
+    for (int i = 0; i < 8; ++i)
+    {
+        const uint64 a = readSyscalls();
+        const uint64 b = readSyscalls();
+        baseline = jmin(baseline, (int64) (b - a));
+    }
+    syscallBaseline = baseline;
+
+    // The first backtrace() loads libgcc; do that now rather than mid-block
+    void* warm[2];
+    backtrace(warm, 2);
+    return true;
+}
+
+void RtAudit::closeSyscallCounter()
+{
+    if (syscallFd >= 0)
+        ::close(syscallFd);
+    syscallFd = -1;
+}
+
+void RtAudit::setBacktraceLimit(int n)
+{
+    backtraceLimit = jlimit(0, maxBacktraces, n);
+    backtraceCount = 0;
+
+    if (n > 0)
+    {
+        void* warm[2];
+        backtrace(warm, 2);
+    }
+}
+
+void RtAudit::begin()
+{
+    counts = Counts();
+    syscallsAtBegin = readSyscalls();
+    active = true;
+}
+
+RtAudit::Counts RtAudit::end()
+{
+    active = false;
+    Counts result = counts;
+
+    if (syscallFd >= 0)
+        result.syscalls = jmax((int64) 0, (int64) (readSyscalls() - syscallsAtBegin) - syscallBaseline);
+
+    return result;
+}
+
+void RtAudit::printBacktraces(const String& tag)
+{
+    for (int i = 0; i < backtraceCount; ++i)
+    {
+        const auto& bt = backtraces[i];
+        std::cerr << "RT-AUDIT " << tag << ": " << bt.call;
+        if (bt.bytes > 0) std::cerr << "(" << bt.bytes << " bytes)";
+        std::cerr << " inside processBlock, backtrace:" << std::endl;
+        backtrace_symbols_fd(bt.frames, bt.depth, 2);
+    }
+    backtraceCount = 0;
+}
+
+#else
+
+// Without glibc there is nothing to interpose; audits report no data
+
+bool RtAudit::hooksAvailable() { return false; }
+
+bool RtAudit::openSyscallCounter(String& error)
+{
+    error = "syscall counting needs Linux";
+    return false;
+}
+
+void RtAudit::closeSyscallCounter() {}
+void RtAudit::setBacktraceLimit(int) {}
+void RtAudit::begin() {}
+RtAudit::Counts RtAudit::end() { return {}; }
+void RtAudit::printBacktraces(const String&) {}
+
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+#include <juce_core/juce_core.h>
+
+using namespace juce;
+
+/**
+ * Real-time safety audit of the measuring thread.
+ *
+ * On Linux/glibc, rt_audit.cpp interposes the allocator (malloc, calloc,
+ * realloc, reallocarray, free, posix_memalign, aligned_alloc, memalign,
+ * valloc, pvalloc - operator new ends up there too) and the pthread mutex, rwlock and condition-variable calls
+ * for the whole process. Between begin() and end() those calls made on the
+ * calling thread are counted; calls on other threads, and calls outside
+ * the window, are just forwarded.
+ *
+ * Syscalls are counted with a per-thread perf_event on the
+ * raw_syscalls:sys_enter tracepoint, so no ptrace or seccomp supervisor is
+ * needed. That usually requires perf_event_paranoid <= -1 or CAP_PERFMON;
+ * without it syscalls stay at -1 and everything else still works.
+ *
+ * Optionally the first N offending calls keep a backtrace, printed after the
+ * pass with printBacktraces(). backtrace() itself runs inside the window,
+ * so Counts::backtraces tells the caller to leave that block out of its
+ * timing.
+ *
+ * Only the symbols listed in rt_audit.exports are exported from the
+ * executable, so plugins bind to these hooks but keep their own copies of
+ * everything else (JUCE, the VST3 SDK). The hooks are linked in and sit in
+ * front of every allocation and lock of the process whether or not an audit
+ * is running; outside begin()/end() they only forward.
+ */
+struct RtAudit {
+    struct Counts {
+        uint64 allocs = 0;      // malloc/calloc/realloc/aligned allocations
+        uint64 frees = 0;
+        uint64 allocBytes = 0;
+        uint64 lockOps = 0;     // mutex lock/trylock/unlock, rwlock lock/unlock
+        uint64 condOps = 0;     // condvar wait/timedwait/signal/broadcast
+        int64 syscalls = -1;    // -1 when the syscall counter is unavailable
+        int backtraces = 0;     // backtraces captured inside the window (not part of any())
+
+        bool any() const { return allocs + frees + lockOps + condOps > 0 || syscalls > 0; }
+    };
+
+    /** True when the allocator/pthread hooks are compiled in (Linux/glibc). */
+    static bool hooksAvailable();
+
+    /** Open the syscall counter for the calling thread. */
+    static bool openSyscallCounter(String& error);
+    static void closeSyscallCounter();
+
+    /** Keep backtraces for the first n offending calls of the calling thread. */
+    static void setBacktraceLimit(int n);
+
+    /** Start counting on the calling thread. */
+    static void begin();
+
+    /** Stop counting and return what happened since begin(). */
+    static Counts end();
+
+    /** Print and forget the captured backtraces, each headed by tag. */
+    static void printBacktraces(const String& tag);
+};
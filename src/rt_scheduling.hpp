@@ -0,0 +1,301 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_LINUX
+ #include <unistd.h>
+ #include <sys/syscall.h>
+ #ifndef SCHED_DEADLINE
+  #define SCHED_DEADLINE 6
+ #endif
+#endif
+
+using namespace juce;
+
+/**
+ * Scheduling policy requested for the measuring thread.
+ *   None     - measure on the calling (message) thread, as before
+ *   Fifo     - dedicated thread with SCHED_FIFO at a fixed priority
+ *   Deadline - dedicated thread with SCHED_DEADLINE (Linux), the block
+ *              period used as both deadline and period
+ */
+enum class SchedPolicy {
+    None,
+    Fifo,
+    Deadline
+};
+
+/**
+ * Thin wrappers around the OS scheduling calls used by the benchmark
+ * threads. All functions act on the calling thread.
+ */
+struct RealtimeScheduling {
+    static bool parsePolicy(const std::string& name, SchedPolicy& out) {
+        if (name == "none")     { out = SchedPolicy::None;     return true; }
+        if (name == "fifo")     { out = SchedPolicy::Fifo;     return true; }
+        if (name == "deadline") { out = SchedPolicy::Deadline; return true; }
+        return false;
+    }
+
+    /**
+     * Switch the calling thread to SCHED_FIFO with the given priority (1-99).
+     */
+    static bool applyFifo(int priority, String& error) {
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        sched_param param {};
+        param.sched_priority = priority;
+        const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0) {
+            error = String("pthread_setschedparam(SCHED_FIFO) failed: ") + std::strerror(rc);
+            return false;
+        }
+        return true;
+       #else
+        ignoreUnused(priority);
+        error = "SCHED_FIFO is not available on this platform";
+        return false;
+       #endif
+    }
+
+    /**
+     * Switch the calling thread to SCHED_DEADLINE. Times are in nanoseconds and
+     * must satisfy runtime <= deadline <= period (kernel admission control).
+     */
+    static bool applyDeadline(int64 runtimeNs, int64 deadlineNs, int64 periodNs, String& error) {
+       #if JUCE_LINUX && defined(SYS_sched_setattr)
+        SchedAttr attr {};
+        attr.size = sizeof(attr);
+        attr.sched_policy = SCHED_DEADLINE;
+        attr.sched_runtime = (uint64) runtimeNs;
+        attr.sched_deadline = (uint64) deadlineNs;
+        attr.sched_period = (uint64) periodNs;
+
+        if (syscall(SYS_sched_setattr, 0, &attr, 0) != 0) {
+            error = String("sched_setattr(SCHED_DEADLINE) failed: ") + std::strerror(errno);
+            return false;
+        }
+        return true;
+       #else
+        ignoreUnused(runtimeNs, deadlineNs, periodNs);
+        error = "SCHED_DEADLINE is only available on Linux";
+        return false;
+       #endif
+    }
+
+    /**
+     * Apply a SchedPolicy to the calling thread. For Deadline the period is used
+     * as the deadline and runtimePct of it as the runtime. None is a no-op.
+     */
+    static bool applyPolicy(SchedPolicy policy, int priority, int64 periodNs,
+                            double runtimePct, String& error) {
+        switch (policy) {
+            case SchedPolicy::None:
+                return true;
+            case SchedPolicy::Fifo:
+                return applyFifo(priority, error);
+            case SchedPolicy::Deadline:
+                return applyDeadline((int64) ((double) periodNs * runtimePct / 100.0),
+                                     periodNs, periodNs, error);
+        }
+        return true;
+    }
+
+    /**
+     * End the calling thread's current SCHED_DEADLINE job: it sleeps until its
+     * next period and starts that with the full runtime, instead of running
+     * on until the CBS throttles it in the middle of some later block.
+     */
+    static void endDeadlineJob() {
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        sched_yield();
+       #endif
+    }
+
+    /**
+     * Pin the calling thread to one logical CPU. On Linux the index counts the
+     * CPUs the process was allowed to run on before the first pin (a taskset
+     * or plugperf-batch slot stays respected) and wraps around them.
+     * Elsewhere it wraps around the CPU count and goes through JUCE, whose
+     * affinity masks cover the first 32 CPUs.
+     */
+    static void pinToCpu(int index) {
+       #if JUCE_LINUX
+        const auto& allowed = allowedCpus();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(allowed[(size_t) index % allowed.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+       #else
+        const int cpu = index % jmax(1, SystemStats::getNumCpus());
+        Thread::setCurrentThreadAffinityMask((uint32) 1 << (cpu % 32));
+       #endif
+    }
+
+    /**
+     * Number of logical CPUs pinToCpu() cycles through: those the process may
+     * run on (Linux), otherwise all of them.
+     */
+    static int allowedCpuCount() {
+       #if JUCE_LINUX
+        return (int) allowedCpus().size();
+       #else
+        return jmax(1, SystemStats::getNumCpus());
+       #endif
+    }
+
+    /**
+     * One iteration of a busy-wait: tells the core we are spinning, so a
+     * sibling hyperthread is not starved and the exit does not mispredict.
+     */
+    static void spinPause() {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && (defined(__GNUC__) || defined(__clang__))
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    /**
+     * Busy-wait step for a waiter that may be SCHED_FIFO: spins, but gives the
+     * CPU away every spinsBeforeYield calls, so a same-priority thread it waits
+     * on and shares the CPU with still gets to run.
+     */
+    static void spinOrYield(int& spins) {
+        constexpr int spinsBeforeYield = 1024;
+        if (++spins < spinsBeforeYield) {
+            spinPause();
+            return;
+        }
+        spins = 0;
+        std::this_thread::yield();
+    }
+
+    /**
+     * Describe the policy the kernel actually granted the calling thread,
+     * e.g. "SCHED_FIFO:80", "SCHED_DEADLINE:950us/1000us" or "SCHED_OTHER".
+     */
+    static std::string describeCurrentThread() {
+       #if JUCE_LINUX && defined(SYS_sched_getattr)
+        SchedAttr attr {};
+        if (syscall(SYS_sched_getattr, 0, &attr, sizeof(attr), 0) == 0
+            && attr.sched_policy == SCHED_DEADLINE) {
+            return "SCHED_DEADLINE:" + std::to_string(attr.sched_runtime / 1000) + "us/"
+                   + std::to_string(attr.sched_period / 1000) + "us";
+        }
+       #endif
+
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        int policy = 0;
+        sched_param param {};
+        if (pthread_getschedparam(pthread_self(), &policy, &param) != 0)
+            return "unknown";
+
+        switch (policy) {
+            case SCHED_FIFO:  return "SCHED_FIFO:" + std::to_string(param.sched_priority);
+            case SCHED_RR:    return "SCHED_RR:" + std::to_string(param.sched_priority);
+            case SCHED_OTHER: return "SCHED_OTHER";
+           #if JUCE_LINUX
+            case SCHED_BATCH: return "SCHED_BATCH";
+            case SCHED_IDLE:  return "SCHED_IDLE";
+           #endif
+            default:          return "policy_" + std::to_string(policy);
+        }
+       #else
+        return "unknown";
+       #endif
+    }
+
+   #if JUCE_LINUX
+    /**
+     * The CPUs the process may run on, ascending, as sched_getaffinity()
+     * reported them on first use (before any pin of ours narrowed the mask).
+     */
+    static const std::vector<int>& allowedCpus() {
+        static const std::vector<int> cpus = [] {
+            std::vector<int> list;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                for (int c = 0; c < CPU_SETSIZE; ++c)
+                    if (CPU_ISSET(c, &set))
+                        list.push_back(c);
+            if (list.empty())
+                list.push_back(0);
+            return list;
+        }();
+        return cpus;
+    }
+   #endif
+
+private:
+   #if JUCE_LINUX
+    // Mirrors the kernel's struct sched_attr (named differently to avoid
+    // clashing with the declaration newer glibc versions ship in <sched.h>)
+    struct SchedAttr {
+        uint32 size;
+        uint32 sched_policy;
+        uint64 sched_flags;
+        int32  sched_nice;
+        uint32 sched_priority;
+        uint64 sched_runtime;
+        uint64 sched_deadline;
+        uint64 sched_period;
+    };
+   #endif
+};
+
+/**
+ * Saves the calling thread's scheduling policy and CPU affinity and puts them
+ * back on destruction. For modes that borrow the message thread as real-time
+ * worker 0: it must not stay SCHED_FIFO and pinned once the trial is over.
+ */
+class ScopedSchedulingState {
+public:
+    ScopedSchedulingState() {
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        policySaved_ = pthread_getschedparam(pthread_self(), &policy_, &param_) == 0;
+       #endif
+       #if JUCE_LINUX
+        CPU_ZERO(&cpus_);
+        cpusSaved_ = pthread_getaffinity_np(pthread_self(), sizeof(cpus_), &cpus_) == 0;
+       #endif
+    }
+
+    ScopedSchedulingState(const ScopedSchedulingState&) = delete;
+    ScopedSchedulingState& operator=(const ScopedSchedulingState&) = delete;
+
+    ~ScopedSchedulingState() {
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        if (policySaved_)
+            pthread_setschedparam(pthread_self(), policy_, &param_);
+       #endif
+       #if JUCE_LINUX
+        if (cpusSaved_)
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus_), &cpus_);
+       #endif
+    }
+
+private:
+   #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+    int policy_ = 0;
+    sched_param param_ {};
+    bool policySaved_ = false;
+   #endif
+   #if JUCE_LINUX
+    cpu_set_t cpus_;
+    bool cpusSaved_ = false;
+   #endif
+};
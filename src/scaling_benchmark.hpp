@@ -0,0 +1,328 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "rt_scheduling.hpp"
+#include "block_timer.hpp"
+#include "latency_histogram.hpp"
+#include "period_pacer.hpp"
+
+using namespace juce;
+
+struct ScalingConfig {
+    // Creates one configured (layout, precision, preset) but unprepared instance
+    std::function<std::unique_ptr<AudioPluginInstance>()> createInstance;
+    int blockSize = 0;
+    int channels = 0;
+    double sampleRate = 0.0;
+    int warmupPeriods = 0;
+    int timedPeriods = 0;
+    bool useDoublePrecision = false;
+    bool nonRealtime = false;
+    SchedPolicy schedPolicy = SchedPolicy::None; // None or Fifo (deadline threads cannot spawn workers)
+    int rtPriority = 80;
+    TimerBackend timer = TimerBackend::Juce;
+    PacingMode pacing = PacingMode::None;
+    double targetMissRate = 0.001;   // a trial passes at or below this miss rate
+    int maxInstances = 256;          // search ceiling
+    bool pinThreads = false;         // pin worker i to logical CPU i
+};
+
+/** One fixed (instances, threads) run of timedPeriods periods. */
+struct ScalingTrial {
+    int instances = 0;
+    uint64 misses = 0;
+    double missRate = 0.0;
+    double meanPeriod = 0.0, p99Period = 0.0, maxPeriod = 0.0; // us, all instances
+    bool passed = false;
+};
+
+/** Search result for one worker-thread count: a point on the scaling curve. */
+struct ScalingPoint {
+    int threads = 0;
+    int maxInstances = 0;   // largest K that met the target (0 if even one instance missed)
+    ScalingTrial atMax;     // the passing trial at maxInstances
+    int trials = 0;
+    bool capped = false;    // hit ScalingConfig::maxInstances without failing
+    std::string schedPolicy;
+};
+
+/**
+ * How many instances of one plugin fit in the real-time budget on M threads.
+ *
+ * K instances are distributed round-robin over M workers. The calling thread
+ * is worker 0 and acts as the device callback: each period it releases the
+ * other workers, processes its own share and waits for all of them. The
+ * period counts as missed when the last instance finishes after block / sr.
+ *
+ * For each thread count, K doubles until a trial exceeds the target miss rate
+ * and is then bisected between the last pass and the first failure.
+ * Instances are created and prepared on the calling (message) thread as the
+ * search needs them and reused by later trials. Pinning and SCHED_FIFO are
+ * applied to the calling thread for the timed part of each trial only and
+ * undone before it returns.
+ */
+class ScalingBenchmark {
+public:
+    explicit ScalingBenchmark(const ScalingConfig& cfg) : cfg_(cfg) {}
+
+    ~ScalingBenchmark()
+    {
+        for (auto& slot : pool_)
+            slot->plugin->releaseResources();
+    }
+
+    ScalingPoint measure(int threads)
+    {
+        ScalingPoint point;
+        point.threads = threads;
+
+        const String tag = "[scaling threads=" + String(threads) + "]";
+
+        auto trial = [&](int k) {
+            ScalingTrial t = cfg_.useDoublePrecision ? runTrial<double>(k, threads)
+                                                     : runTrial<float>(k, threads);
+            ++point.trials;
+            std::cerr << tag << " K=" << k << ": miss rate " << t.missRate
+                      << ", max period " << t.maxPeriod << "us"
+                      << (t.passed ? " (pass)" : " (fail)") << "\n";
+            return t;
+        };
+
+        int lo = 0, hi = 0;  // lo passes (0 = none yet), hi fails (0 = none yet)
+        ScalingTrial best;
+
+        for (int k = 1;; k = jmin(k * 2, cfg_.maxInstances))
+        {
+            if (! ensureInstances(k)) { hi = k; break; }
+
+            const ScalingTrial t = trial(k);
+            if (! t.passed) { hi = k; break; }
+
+            lo = k;
+            best = t;
+            if (k == cfg_.maxInstances) { point.capped = true; break; }
+        }
+
+        while (hi - lo > 1)
+        {
+            const int mid = lo + (hi - lo) / 2;
+            if (! ensureInstances(mid)) { hi = mid; continue; }
+
+            const ScalingTrial t = trial(mid);
+            if (t.passed) { lo = mid; best = t; }
+            else hi = mid;
+        }
+
+        point.maxInstances = lo;
+        point.atMax = best;
+        point.schedPolicy = workerPolicy_;
+        return point;
+    }
+
+private:
+    struct Slot {
+        std::unique_ptr<AudioPluginInstance> plugin;
+        AudioBuffer<float> floatBuffer;
+        AudioBuffer<double> doubleBuffer;
+        MidiBuffer midi;
+
+        template <typename Sample>
+        AudioBuffer<Sample>& buffer()
+        {
+            if constexpr (std::is_same_v<Sample, double>) return doubleBuffer;
+            else return floatBuffer;
+        }
+    };
+
+    /** Helper workers 1..M-1; worker 0 is the calling thread. */
+    class Worker : public Thread {
+    public:
+        Worker(ScalingBenchmark& owner, int index)
+            : Thread("PlugPerf Scaling Worker " + String(index)), owner_(owner), index_(index) {}
+
+        ~Worker() override { stopThread(2000); }
+
+        void run() override
+        {
+            owner_.applyWorkerSetup(index_);
+
+            int64 seen = 0;
+            for (;;)
+            {
+                int64 epoch;
+                while ((epoch = owner_.epoch_.load(std::memory_order_acquire)) == seen)
+                {
+                    if (threadShouldExit()) return;
+                    std::this_thread::yield();
+                }
+
+                seen = epoch;
+                if (threadShouldExit()) return;
+
+                owner_.processShare(index_);
+                owner_.done_.fetch_add(1, std::memory_order_acq_rel);
+            }
+        }
+
+    private:
+        ScalingBenchmark& owner_;
+        const int index_;
+    };
+
+    bool ensureInstances(int k)
+    {
+        while ((int) pool_.size() < k)
+        {
+            auto slot = std::make_unique<Slot>();
+            slot->plugin = cfg_.createInstance();
+            if (slot->plugin == nullptr)
+            {
+                std::cerr << "WARNING: Could not create instance " << pool_.size() + 1
+                          << "; stopping the search there.\n";
+                return false;
+            }
+
+            slot->plugin->setNonRealtime(cfg_.nonRealtime);
+            slot->plugin->prepareToPlay(cfg_.sampleRate, cfg_.blockSize);
+
+            // Per-instance input, seeded differently so instances do not alias
+            Random rng(12345 + (int64) pool_.size());
+            auto fill = [&](auto& buf) {
+                buf.setSize(cfg_.channels, cfg_.blockSize);
+                for (int c = 0; c < cfg_.channels; ++c)
+                    for (int n = 0; n < cfg_.blockSize; ++n)
+                        buf.setSample(c, n, (rng.nextFloat() * 2.0f - 1.0f) * 0.1f);
+            };
+
+            if (cfg_.useDoublePrecision) fill(slot->doubleBuffer);
+            else fill(slot->floatBuffer);
+
+            pool_.push_back(std::move(slot));
+        }
+        return true;
+    }
+
+    void applyWorkerSetup(int index)
+    {
+        if (cfg_.pinThreads)
+            RealtimeScheduling::pinToCpu(index);
+
+        String error;
+        if (cfg_.schedPolicy == SchedPolicy::Fifo && ! RealtimeScheduling::applyFifo(cfg_.rtPriority, error))
+            std::cerr << "WARNING: worker " << index << ": " << error << "\n";
+    }
+
+    void processShare(int worker)
+    {
+        if (cfg_.useDoublePrecision) processShareImpl<double>(worker);
+        else processShareImpl<float>(worker);
+    }
+
+    template <typename Sample>
+    void processShareImpl(int worker)
+    {
+        for (int i = worker; i < activeInstances_; i += activeThreads_)
+        {
+            auto& slot = *pool_[(size_t) i];
+            slot.midi.clear();
+            slot.plugin->processBlock(slot.buffer<Sample>(), slot.midi);
+        }
+    }
+
+    template <typename Sample>
+    ScalingTrial runTrial(int instances, int threads)
+    {
+        ScopedNoDenormals noDenormals;
+
+        // The calling thread is worker 0 until this trial ends
+        const ScopedSchedulingState restoreScheduling;
+        applyWorkerSetup(0);
+        workerPolicy_ = RealtimeScheduling::describeCurrentThread();
+
+        activeInstances_ = instances;
+        activeThreads_ = threads;
+        epoch_.store(0);
+        done_.store(0);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (int w = 1; w < threads; ++w)
+        {
+            workers.push_back(std::make_unique<Worker>(*this, w));
+            workers.back()->startThread(Thread::Priority::highest);
+        }
+
+        const BlockTimer timer(cfg_.timer);
+        const double usPerTick = timer.ticksToMicros(1);
+        const double budget_us = (double) cfg_.blockSize * 1e6 / cfg_.sampleRate;
+        const int64 budgetTicks = (int64) (budget_us / usPerTick);
+
+        LatencyHistogram hist;
+        uint64 misses = 0;
+
+        PeriodPacer pacer(cfg_.pacing, (double) cfg_.blockSize / cfg_.sampleRate);
+        pacer.start();
+
+        // One period: release the helpers, do our share, wait for everyone
+        auto period = [&]() -> int64 {
+            if (cfg_.pacing != PacingMode::None)
+                pacer.waitForDeadline();
+
+            done_.store(0, std::memory_order_relaxed);
+            const int64 t0 = timer.start();
+            epoch_.fetch_add(1, std::memory_order_acq_rel);
+            processShareImpl<Sample>(0);
+            int spins = 0;
+            while (done_.load(std::memory_order_acquire) < threads - 1)
+                RealtimeScheduling::spinOrYield(spins);
+            const int64 t1 = timer.stop();
+
+            if (cfg_.pacing != PacingMode::None)
+                pacer.finishPeriod();
+            return t1 - t0;
+        };
+
+        for (int i = 0; i < cfg_.warmupPeriods; ++i)
+            period();
+
+        for (int i = 0; i < cfg_.timedPeriods; ++i)
+        {
+            const int64 elapsed = period();
+            hist.record(elapsed);
+            if (elapsed > budgetTicks) ++misses;
+        }
+
+        for (auto& w : workers)
+            w->signalThreadShouldExit();
+        epoch_.fetch_add(1, std::memory_order_acq_rel);
+        workers.clear();
+
+        ScalingTrial t;
+        t.instances = instances;
+        t.misses = misses;
+        t.missRate = cfg_.timedPeriods > 0 ? (double) misses / (double) cfg_.timedPeriods : 0.0;
+        t.meanPeriod = hist.mean() * usPerTick;
+        t.p99Period = hist.valueAtQuantile(0.99) * usPerTick;
+        t.maxPeriod = (double) hist.max() * usPerTick;
+        t.passed = t.missRate <= cfg_.targetMissRate;
+        return t;
+    }
+
+    ScalingConfig cfg_;
+    std::vector<std::unique_ptr<Slot>> pool_;
+
+    std::atomic<int64> epoch_ { 0 };
+    std::atomic<int> done_ { 0 };
+    int activeInstances_ = 0;
+    int activeThreads_ = 1;
+    std::string workerPolicy_;   // granted to worker 0 in the latest trial
+};
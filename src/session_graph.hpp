@@ -0,0 +1,197 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace juce;
+
+/**
+ * A mixer session as a processing DAG: tracks feed buses, buses feed other
+ * buses or the master. Every node owns one buffer and runs its plugins as a
+ * serial insert chain; bus and master nodes first sum their inputs.
+ *
+ * Session file (JSON), plugin paths relative to the file:
+ *
+ *   {
+ *     "tracks": [ { "name": "Kick",  "plugins": ["eq.vst3", "comp.vst3"], "output": "Drums" },
+ *                 { "name": "Vocal", "plugins": ["eq.vst3"] } ],
+ *     "buses":  [ { "name": "Drums", "plugins": ["glue.vst3"], "output": "master" } ],
+ *     "master": { "plugins": ["limiter.vst3"] }
+ *   }
+ *
+ * "output" defaults to "master", which always names the master node (its
+ * own "name" only labels the rows). The master node always exists.
+ */
+struct SessionGraph {
+    enum class Kind { Track, Bus, Master };
+
+    struct Node {
+        String name;
+        Kind kind = Kind::Track;
+        StringArray plugins;      // absolute plugin paths, in processing order
+        std::vector<int> inputs;  // nodes summed into this one
+        std::vector<int> outputs; // nodes this one feeds (at most one today)
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> order;       // topological order, sources first
+    int master = -1;
+
+    static const char* kindName(Kind k) {
+        switch (k) {
+            case Kind::Track:  return "track";
+            case Kind::Bus:    return "bus";
+            case Kind::Master: return "master";
+        }
+        return "track";
+    }
+
+    /** Parse a session file. On failure, error says what is wrong. */
+    static bool load(const File& file, SessionGraph& out, String& error) {
+        out = SessionGraph();
+
+        if (! file.existsAsFile()) {
+            error = "session file not found: " + file.getFullPathName();
+            return false;
+        }
+
+        var json;
+        const Result parsed = JSON::parse(file.loadFileAsString(), json);
+        if (parsed.failed()) {
+            error = "failed to parse session JSON: " + parsed.getErrorMessage();
+            return false;
+        }
+
+        if (! json.isObject()) {
+            error = "session root must be an object";
+            return false;
+        }
+
+        const File baseDir = file.getParentDirectory();
+        std::map<std::string, int> byName;
+        std::vector<String> routedTo;
+
+        auto addNode = [&](const var& desc, Kind kind, const String& fallbackName) -> bool {
+            Node node;
+            node.kind = kind;
+            node.name = desc.getProperty("name", fallbackName).toString();
+
+            // "master" always means the master node, whatever it is called,
+            // so its name is no routing key and a bus cannot take that one
+            if (kind == Kind::Bus && node.name == "master") {
+                error = "bus name 'master' is reserved for the master output";
+                return false;
+            }
+            if (kind != Kind::Master && byName.count(node.name.toStdString()) != 0) {
+                error = "duplicate node name: " + node.name;
+                return false;
+            }
+
+            if (auto* plugins = desc["plugins"].getArray()) {
+                for (const auto& p : *plugins) {
+                    const String path = p.toString();
+                    node.plugins.add(File::isAbsolutePath(path) ? path
+                                                                : baseDir.getChildFile(path).getFullPathName());
+                }
+            }
+
+            if (kind != Kind::Master)
+                byName[node.name.toStdString()] = (int) out.nodes.size();
+            routedTo.push_back(kind == Kind::Master ? String()
+                                                    : desc.getProperty("output", "master").toString());
+            out.nodes.push_back(node);
+            return true;
+        };
+
+        if (auto* tracks = json["tracks"].getArray())
+            for (int i = 0; i < tracks->size(); ++i)
+                if (! addNode(tracks->getReference(i), Kind::Track, "track" + String(i + 1)))
+                    return false;
+
+        if (auto* buses = json["buses"].getArray())
+            for (int i = 0; i < buses->size(); ++i)
+                if (! addNode(buses->getReference(i), Kind::Bus, "bus" + String(i + 1)))
+                    return false;
+
+        if (! addNode(json.hasProperty("master") ? json["master"] : var(), Kind::Master, "master"))
+            return false;
+        out.master = (int) out.nodes.size() - 1;
+
+        if (out.nodes.size() == 1 && out.nodes[0].plugins.size() == 0) {
+            error = "session has no tracks and no plugins";
+            return false;
+        }
+
+        for (size_t i = 0; i < out.nodes.size(); ++i) {
+            if (routedTo[i].isEmpty())
+                continue;
+
+            int target = out.master;
+            if (routedTo[i] != "master") {
+                const auto it = byName.find(routedTo[i].toStdString());
+                if (it == byName.end() || out.nodes[(size_t) it->second].kind == Kind::Track) {
+                    error = "node '" + out.nodes[i].name + "' routes to unknown bus '" + routedTo[i] + "'";
+                    return false;
+                }
+                target = it->second;
+            }
+
+            out.nodes[i].outputs.push_back(target);
+            out.nodes[(size_t) target].inputs.push_back((int) i);
+        }
+
+        // Kahn's algorithm; anything left over sits on a routing loop
+        std::vector<int> pending(out.nodes.size());
+        for (size_t i = 0; i < out.nodes.size(); ++i) {
+            pending[i] = (int) out.nodes[i].inputs.size();
+            if (pending[i] == 0)
+                out.order.push_back((int) i);
+        }
+
+        for (size_t k = 0; k < out.order.size(); ++k)
+            for (int next : out.nodes[(size_t) out.order[k]].outputs)
+                if (--pending[(size_t) next] == 0)
+                    out.order.push_back(next);
+
+        if (out.order.size() != out.nodes.size()) {
+            error = "session routing contains a cycle";
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Longest (most expensive) source-to-sink path given a cost per node.
+     * Returns the nodes on it, sources first, and its total cost in length.
+     */
+    std::vector<int> criticalPath(const std::vector<double>& cost, double& length) const {
+        std::vector<double> finish(nodes.size(), 0.0);
+        std::vector<int> via(nodes.size(), -1);
+
+        for (int n : order) {
+            double start = 0.0;
+            for (int in : nodes[(size_t) n].inputs) {
+                if (finish[(size_t) in] > start) {
+                    start = finish[(size_t) in];
+                    via[(size_t) n] = in;
+                }
+            }
+            finish[(size_t) n] = start + cost[(size_t) n];
+        }
+
+        int end = master;
+        for (size_t n = 0; n < nodes.size(); ++n)
+            if (finish[n] > finish[(size_t) end])
+                end = (int) n;
+
+        length = end >= 0 ? finish[(size_t) end] : 0.0;
+
+        std::vector<int> path;
+        for (int n = end; n >= 0; n = via[(size_t) n])
+            path.insert(path.begin(), n);
+        return path;
+    }
+};
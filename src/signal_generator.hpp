@@ -0,0 +1,212 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace juce;
+
+/**
+ * Something that refills the processing buffer before every block, outside
+ * the timed region. Both overloads write buf.getNumSamples() frames to every
+ * channel and advance the source.
+ */
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    virtual void fill(AudioBuffer<float>& buf) = 0;
+    virtual void fill(AudioBuffer<double>& buf) = 0;
+
+    /** Back to the start, so every pass sees the same material. */
+    virtual void rewind() = 0;
+};
+
+enum class Stimulus { Silence, White, Pink, Sweep, Impulse, Clip, Transient, Decay };
+
+/**
+ * Built-in test signals. Each one is rendered once as a loop of a few
+ * seconds, so refilling a block is a copy however expensive the signal is
+ * to synthesise, and the material repeats identically across passes.
+ */
+class SignalGenerator : public InputSource {
+public:
+    static bool parse(const std::string& s, Stimulus& out) {
+        if (s == "silence") out = Stimulus::Silence;
+        else if (s == "white") out = Stimulus::White;
+        else if (s == "pink") out = Stimulus::Pink;
+        else if (s == "sweep") out = Stimulus::Sweep;
+        else if (s == "impulse") out = Stimulus::Impulse;
+        else if (s == "clip") out = Stimulus::Clip;
+        else if (s == "transient") out = Stimulus::Transient;
+        else if (s == "decay") out = Stimulus::Decay;
+        else return false;
+        return true;
+    }
+
+    static const char* name(Stimulus s) {
+        switch (s) {
+            case Stimulus::Silence:   return "silence";
+            case Stimulus::White:     return "white";
+            case Stimulus::Pink:      return "pink";
+            case Stimulus::Sweep:     return "sweep";
+            case Stimulus::Impulse:   return "impulse";
+            case Stimulus::Clip:      return "clip";
+            case Stimulus::Transient: return "transient";
+            case Stimulus::Decay:     return "decay";
+        }
+        return "?";
+    }
+
+    SignalGenerator(Stimulus s, double sampleRate, int channels)
+        : loop_(jmax(1, channels), jmax(1, (int) (sampleRate * loopSeconds(s))))
+    {
+        render(s, sampleRate);
+    }
+
+    void fill(AudioBuffer<float>& buf) override { fillImpl(buf); }
+    void fill(AudioBuffer<double>& buf) override { fillImpl(buf); }
+    void rewind() override { pos_ = 0; }
+
+    /** Subnormal samples in the loop, read from the bits so FTZ/DAZ cannot hide them. */
+    int64 subnormalSamples() const {
+        int64 count = 0;
+        for (int c = 0; c < loop_.getNumChannels(); ++c) {
+            const float* d = loop_.getReadPointer(c);
+            for (int n = 0; n < loop_.getNumSamples(); ++n) {
+                uint32 bits;
+                std::memcpy(&bits, d + n, sizeof(bits));
+                if ((bits & 0x7f800000u) == 0 && (bits & 0x007fffffu) != 0) ++count;
+            }
+        }
+        return count;
+    }
+
+private:
+    static double loopSeconds(Stimulus s) {
+        switch (s) {
+            case Stimulus::Sweep:   return 5.0;  // one log sweep
+            case Stimulus::Impulse: return 1.0;  // one click per second
+            case Stimulus::Decay:   return 4.0;  // burst, tail, then true silence
+            default:                return 2.0;
+        }
+    }
+
+    void render(Stimulus s, double sr) {
+        const int len = loop_.getNumSamples();
+        Random rng(12345);
+        loop_.clear();
+
+        for (int c = 0; c < loop_.getNumChannels(); ++c) {
+            float* d = loop_.getWritePointer(c);
+
+            switch (s) {
+                case Stimulus::Silence:
+                    break;
+
+                case Stimulus::White:
+                    // -6 dBFS peak, independent per channel
+                    for (int n = 0; n < len; ++n)
+                        d[n] = (rng.nextFloat() * 2.0f - 1.0f) * 0.5f;
+                    break;
+
+                case Stimulus::Pink: {
+                    // Paul Kellet's economy filter, -3 dB/octave from white
+                    float b0 = 0, b1 = 0, b2 = 0;
+                    for (int n = 0; n < len; ++n) {
+                        const float w = rng.nextFloat() * 2.0f - 1.0f;
+                        b0 = 0.99765f * b0 + w * 0.0990460f;
+                        b1 = 0.96300f * b1 + w * 0.2965164f;
+                        b2 = 0.57000f * b2 + w * 1.0526913f;
+                        d[n] = (b0 + b1 + b2 + w * 0.1848f) * 0.125f;
+                    }
+                    break;
+                }
+
+                case Stimulus::Sweep: {
+                    // Exponential sine sweep 20 Hz -> 0.45 * sr at -6 dBFS
+                    const double f0 = 20.0, f1 = 0.45 * sr, T = (double) len / sr;
+                    const double k = std::log(f1 / f0);
+                    for (int n = 0; n < len; ++n) {
+                        const double t = (double) n / sr;
+                        const double phase = MathConstants<double>::twoPi * f0 * T / k * (std::exp(t / T * k) - 1.0);
+                        d[n] = (float) (0.5 * std::sin(phase));
+                    }
+                    break;
+                }
+
+                case Stimulus::Impulse:
+                    d[0] = 1.0f;
+                    break;
+
+                case Stimulus::Clip:
+                    // 12 dB overdriven 100 Hz sine, hard clipped at full scale
+                    for (int n = 0; n < len; ++n) {
+                        const double x = 4.0 * std::sin(MathConstants<double>::twoPi * 100.0 * n / sr);
+                        d[n] = (float) jlimit(-1.0, 1.0, x);
+                    }
+                    break;
+
+                case Stimulus::Transient: {
+                    // Noise bursts every 250 ms with a 30 ms decay, silence in between
+                    const int period = jmax(1, (int) (0.25 * sr));
+                    const double decay = std::exp(-1.0 / (0.030 * sr));
+                    double env = 0.0;
+                    for (int n = 0; n < len; ++n) {
+                        if (n % period == 0) env = 0.9;
+                        d[n] = (float) (env * (rng.nextFloat() * 2.0f - 1.0f));
+                        env *= decay;
+                    }
+                    break;
+                }
+
+                case Stimulus::Decay: {
+                    // 50 ms noise burst, then an exponential tail that crosses
+                    // FLT_MIN (~1e-38) just before 2 s; the envelope spends
+                    // about 0.35 s in the subnormal range (quiet noise samples
+                    // linger a little longer) and the rest of the loop is zero.
+                    // Generators are built under the benchmark's
+                    // ScopedNoDenormals, which would flush the tail to 0.0f, so
+                    // it is rendered with FTZ/DAZ cleared. In 64f runs the same
+                    // samples reach the plugin as normal doubles.
+                    const intptr_t fpStatus = FloatVectorOperations::getFpStatusRegister();
+                    FloatVectorOperations::disableDenormalisedNumberSupport(false);
+                    const int burst = (int) (0.05 * sr);
+                    const double decay = std::exp(std::log(1.0e-38) / (2.0 * sr));
+                    double env = 0.5;
+                    for (int n = 0; n < len; ++n) {
+                        const float w = rng.nextFloat() * 2.0f - 1.0f;
+                        if (n >= burst) env *= decay;
+                        d[n] = (float) (env * w);
+                    }
+                    FloatVectorOperations::setFpStatusRegister(fpStatus);
+                    break;
+                }
+            }
+        }
+    }
+
+    template <typename Sample>
+    void fillImpl(AudioBuffer<Sample>& buf) {
+        const int len = loop_.getNumSamples();
+        const int frames = buf.getNumSamples();
+        const int start = pos_;
+
+        for (int c = 0; c < buf.getNumChannels(); ++c) {
+            const float* src = loop_.getReadPointer(c % loop_.getNumChannels());
+            Sample* dst = buf.getWritePointer(c);
+            int p = start;
+            for (int n = 0; n < frames; ++n) {
+                dst[n] = (Sample) src[p];
+                if (++p == len) p = 0;
+            }
+        }
+
+        pos_ = (start + frames) % len;
+    }
+
+    AudioBuffer<float> loop_;
+    int pos_ = 0;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <vector>
+
+using namespace juce;
+
+/**
+ * Chase-Lev work-stealing deque of task indices (Le et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models", PPoPP 2013).
+ *
+ * The owning worker pushes and pops at the bottom; any other thread steals
+ * from the top. The ring has a fixed capacity, sized by the caller for the
+ * most tasks that can be queued at once, so nothing allocates while running.
+ * Lock-free; pop() and steal() return -1 when there is nothing to take.
+ */
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(int capacity)
+        : mask_(nextPowerOfTwo(jmax(2, capacity)) - 1), items_((size_t) mask_ + 1)
+    {
+        for (auto& item : items_)
+            item.store(-1, std::memory_order_relaxed);
+    }
+
+    /** Owner only. */
+    void push(int task)
+    {
+        const int64 b = bottom_.load(std::memory_order_relaxed);
+        items_[(size_t) (b & mask_)].store(task, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /** Owner only: newest task first, for cache locality. */
+    int pop()
+    {
+        const int64 b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64 t = top_.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return -1;
+        }
+
+        int task = items_[(size_t) (b & mask_)].load(std::memory_order_relaxed);
+
+        if (t == b)
+        {
+            // Last item: race any thief for it
+            if (! top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                task = -1;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        return task;
+    }
+
+    /** Any thread: oldest task first. */
+    int steal()
+    {
+        int64 t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64 b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return -1;
+
+        const int task = items_[(size_t) (t & mask_)].load(std::memory_order_relaxed);
+        if (! top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return -1;
+
+        return task;
+    }
+
+private:
+    const int64 mask_;
+    std::vector<std::atomic<int>> items_;
+
+    // Separate cache lines so thieves and the owner do not false-share
+    alignas(64) std::atomic<int64> top_ { 0 };
+    alignas(64) std::atomic<int64> bottom_ { 0 };
+};
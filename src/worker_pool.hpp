@@ -0,0 +1,421 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "rt_scheduling.hpp"
+
+#if JUCE_LINUX
+ #include <sched.h>
+#endif
+
+using namespace juce;
+
+/** Watchdog limits in seconds for each phase a worker reports. */
+struct PhaseTimeouts {
+    double scan = 60.0;      // also covers process start-up before the first marker
+    double load = 60.0;
+    double prepare = 30.0;   // per prepareToPlay
+    double process = 600.0;  // per buffer size (or a whole lifecycle/memory/scaling run)
+
+    double forPhase(const std::string& phase) const {
+        if (phase == "start" || phase == "scan") return scan;
+        if (phase == "load") return load;
+        if (phase == "prepare") return prepare;
+        return process;
+    }
+};
+
+/** One plugin to run in its own worker process. */
+struct BatchJob {
+    std::string pluginPath;
+    std::vector<std::string> argv;  // worker command line, argv[0] = the plugperf binary
+    std::string logPath;            // the worker's stdout and stderr
+};
+
+/** How one worker ended. */
+struct BatchOutcome {
+    std::string pluginPath;
+    std::string status;        // ok, timeout, crash, exit, aborted
+    std::string phase;         // last phase reported; "start" before the first marker
+    int signal = 0;            // crash: the terminating signal
+    int exitCode = 0;          // exit: the non-zero exit status
+    int worker = 0;
+    std::string cpus;          // cores the worker was pinned to, e.g. "2-3"
+    double wallSec = 0.0;
+    std::map<std::string, double> phaseSec;  // seconds spent in each phase, summed over repeats
+    std::string message;       // what the watchdog saw, or the worker's last stderr line
+};
+
+struct WorkerPoolConfig {
+    int workers = 1;
+    int coresPerWorker = 1;
+    int firstCore = 0;
+    bool pin = true;           // worker i gets cores [first + i*k, first + (i+1)*k)
+    PhaseTimeouts timeouts;
+    int memoryLimitMb = 0;     // address-space limit per worker (0 = none)
+};
+
+/**
+ * Runs jobs in forked worker processes, at most cfg.workers at a time.
+ *
+ * Each worker is the plugperf binary, exec'd in its own process group with
+ * stdin on /dev/null, stdout and stderr in its log, core dumps off and
+ * (Linux) its slot's cores as CPU affinity, which every thread it starts
+ * inherits. If that affinity cannot be set the child says so in its log and
+ * on the pipe, and its outcome names no cores. Descriptor 3 is the write end of a pipe that carries the
+ * worker's phase markers (PhaseReport); the pool polls all pipes and
+ * restarts a watchdog on every marker. A worker that stays in one phase
+ * past its timeout has its whole process group killed. Crashes, hangs and
+ * failed exits all become a BatchOutcome naming the phase, so the batch
+ * goes on with the next plugin.
+ */
+class WorkerPool {
+public:
+    static constexpr int kPhaseFd = 3;
+
+    /** Sent on the phase pipe by a child whose sched_setaffinity failed. */
+    static constexpr char kUnpinnedMarker[] = "unpinned\n";
+
+    explicit WorkerPool(const WorkerPoolConfig& cfg) : cfg_(cfg)
+    {
+        for (int i = 0; i < jmax(1, cfg_.workers); ++i) {
+            Slot s;
+            s.index = i;
+            for (int c = 0; c < jmax(1, cfg_.coresPerWorker); ++c)
+                s.cpus.push_back(cpuAt(cfg_.firstCore + i * jmax(1, cfg_.coresPerWorker) + c));
+            slots_.push_back(s);
+        }
+    }
+
+    /** Runs every job; onDone is called on this thread as each one ends. */
+    std::vector<BatchOutcome> run(const std::vector<BatchJob>& jobs,
+                                  const std::function<void(const BatchOutcome&)>& onDone)
+    {
+        std::vector<BatchOutcome> outcomes;
+        installStopHandler();
+
+        size_t next = 0;
+        int active = 0;
+        while ((next < jobs.size() && ! stopRequested()) || active > 0)
+        {
+            for (auto& s : slots_) {
+                if (s.pid > 0 || next >= jobs.size() || stopRequested()) continue;
+                if (spawn(s, jobs[next])) {
+                    ++active;
+                } else {
+                    outcomes.push_back(s.outcome);
+                    onDone(s.outcome);
+                }
+                ++next;
+            }
+
+            std::vector<pollfd> fds;
+            std::vector<Slot*> owners;
+            for (auto& s : slots_) {
+                if (s.pid > 0 && s.phaseFd >= 0) {
+                    fds.push_back({ s.phaseFd, POLLIN, 0 });
+                    owners.push_back(&s);
+                }
+            }
+            if (! fds.empty())
+                ::poll(fds.data(), (nfds_t) fds.size(), 100);
+            else if (active > 0)
+                Thread::sleep(100);
+
+            for (size_t i = 0; i < fds.size(); ++i)
+                if ((fds[i].revents & (POLLIN | POLLHUP)) != 0)
+                    readMarkers(*owners[i]);
+
+            const double now = seconds();
+            for (auto& s : slots_) {
+                if (s.pid <= 0) continue;
+
+                if (s.killedIn.empty()) {
+                    if (stopRequested()) {
+                        kill(-s.pid, SIGKILL);
+                        s.killedIn = s.phase;
+                        s.aborted = true;
+                    } else if (now - s.phaseStarted > cfg_.timeouts.forPhase(s.phase)) {
+                        kill(-s.pid, SIGKILL);
+                        s.killedIn = s.phase;
+                    }
+                }
+
+                // Peek without reaping, so the group id cannot be reused before
+                // the rest of the group (anything the plugin spawned) is killed
+                siginfo_t info {};
+                if (waitid(P_PID, (id_t) s.pid, &info, WEXITED | WNOHANG | WNOWAIT) != 0 || info.si_pid != s.pid)
+                    continue;
+
+                kill(-s.pid, SIGKILL);
+                int status = 0;
+                waitpid(s.pid, &status, 0);
+                readMarkers(s);
+                finish(s, status);
+                --active;
+                outcomes.push_back(s.outcome);
+                onDone(s.outcome);
+            }
+        }
+        return outcomes;
+    }
+
+    /** CPU list in the kernel's cpulist form, e.g. "2-3" or "2,4". */
+    static String describeCpus(const std::vector<int>& cpus)
+    {
+        String text;
+        for (size_t i = 0; i < cpus.size();) {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+            if (text.isNotEmpty()) text << ",";
+            text << cpus[i];
+            if (j > i) text << "-" << cpus[j];
+            i = j + 1;
+        }
+        return text;
+    }
+
+private:
+    struct Slot {
+        int index = 0;
+        std::vector<int> cpus;
+        pid_t pid = -1;
+        int phaseFd = -1;
+        std::string pending;      // partial marker line
+        std::string phase;
+        std::string logPath;
+        double started = 0.0, phaseStarted = 0.0;
+        std::string killedIn;     // phase the watchdog (or a stop) killed the worker in
+        bool aborted = false;
+        BatchOutcome outcome;
+    };
+
+    // Slot cores count the CPUs the batch may run on (Linux), so a taskset
+    // or cpuset around plugperf-batch is respected
+    static int cpuAt(int index)
+    {
+       #if JUCE_LINUX
+        const auto& allowed = RealtimeScheduling::allowedCpus();
+        if (index < (int) allowed.size()) return allowed[(size_t) index];
+       #endif
+        return index;
+    }
+
+    static double seconds() { return Time::getMillisecondCounterHiRes() / 1000.0; }
+
+    static volatile std::sig_atomic_t& stopFlag() {
+        static volatile std::sig_atomic_t flag = 0;
+        return flag;
+    }
+
+    static bool stopRequested() { return stopFlag() != 0; }
+
+    /** Ctrl-C stops the batch; workers sit in their own process groups, so the pool kills them. */
+    static void installStopHandler()
+    {
+        struct sigaction sa {};
+        sa.sa_handler = [](int) { stopFlag() = 1; };
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, nullptr);
+        sigaction(SIGTERM, &sa, nullptr);
+    }
+
+    static void setCloseOnExec(int fd) { fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC); }
+
+    bool spawn(Slot& s, const BatchJob& job)
+    {
+        s.outcome = {};
+        s.outcome.pluginPath = job.pluginPath;
+        s.outcome.worker = s.index;
+        s.outcome.cpus = cfg_.pin ? describeCpus(s.cpus).toStdString() : std::string();
+        s.logPath = job.logPath;
+        s.pending.clear();
+        s.killedIn.clear();
+        s.aborted = false;
+        s.phase = "start";
+        s.started = s.phaseStarted = seconds();
+
+        // Everything the child needs is prepared before fork: after it, only
+        // async-signal-safe calls until exec
+        std::vector<char*> argv;
+        for (const auto& a : job.argv)
+            argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+
+        int pipeFds[2];
+        const int logFd = ::open(job.logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        const int nullFd = ::open("/dev/null", O_RDONLY);
+        if (logFd < 0 || nullFd < 0 || ::pipe(pipeFds) != 0) {
+            s.outcome.status = "exit";
+            s.outcome.phase = "start";
+            s.outcome.exitCode = 127;
+            s.outcome.message = std::string("cannot set up worker: ") + std::strerror(errno);
+            if (logFd >= 0) ::close(logFd);
+            if (nullFd >= 0) ::close(nullFd);
+            return false;
+        }
+        for (int fd : { logFd, nullFd, pipeFds[0], pipeFds[1] })
+            setCloseOnExec(fd);
+
+       #if JUCE_LINUX
+        cpu_set_t affinity;
+        CPU_ZERO(&affinity);
+        for (int c : s.cpus)
+            CPU_SET(c, &affinity);
+       #endif
+        const rlim_t addressLimit = (rlim_t) cfg_.memoryLimitMb * 1024 * 1024;
+
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            setpgid(0, 0);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+
+            dup2(nullFd, 0);
+            dup2(logFd, 1);
+            dup2(logFd, 2);
+            if (pipeFds[1] == kPhaseFd)
+                fcntl(kPhaseFd, F_SETFD, 0);
+            else
+                dup2(pipeFds[1], kPhaseFd);
+
+            const rlimit noCore { 0, 0 };
+            setrlimit(RLIMIT_CORE, &noCore);
+            if (addressLimit > 0) {
+                const rlimit as { addressLimit, addressLimit };
+                setrlimit(RLIMIT_AS, &as);
+            }
+           #if JUCE_LINUX
+            if (cfg_.pin && sched_setaffinity(0, sizeof(affinity), &affinity) != 0) {
+                const char msg[] = "plugperf-batch: sched_setaffinity failed; worker runs unpinned\n";
+                ssize_t rc = ::write(2, msg, sizeof(msg) - 1);
+                rc = ::write(kPhaseFd, kUnpinnedMarker, sizeof(kUnpinnedMarker) - 1);
+                ignoreUnused(rc);
+            }
+           #endif
+
+            execv(argv[0], argv.data());
+            const char msg[] = "plugperf-batch: exec failed\n";
+            ssize_t rc = ::write(2, msg, sizeof(msg) - 1);
+            ignoreUnused(rc);
+            _exit(127);
+        }
+
+        ::close(logFd);
+        ::close(nullFd);
+        ::close(pipeFds[1]);
+
+        if (pid < 0) {
+            ::close(pipeFds[0]);
+            s.outcome.status = "exit";
+            s.outcome.phase = "start";
+            s.outcome.exitCode = 127;
+            s.outcome.message = std::string("fork failed: ") + std::strerror(errno);
+            return false;
+        }
+
+        // Both sides set the group, so kill(-pid) works whichever runs first
+        setpgid(pid, pid);
+        fcntl(pipeFds[0], F_SETFL, fcntl(pipeFds[0], F_GETFL) | O_NONBLOCK);
+        s.pid = pid;
+        s.phaseFd = pipeFds[0];
+        return true;
+    }
+
+    void readMarkers(Slot& s)
+    {
+        if (s.phaseFd < 0) return;
+
+        char buf[256];
+        for (;;) {
+            const ssize_t n = ::read(s.phaseFd, buf, sizeof(buf));
+            if (n <= 0) break;
+            s.pending.append(buf, (size_t) n);
+        }
+
+        size_t eol;
+        while ((eol = s.pending.find('\n')) != std::string::npos) {
+            if (s.pending.compare(0, eol + 1, kUnpinnedMarker) == 0)
+                s.outcome.cpus.clear();
+            else
+                enterPhase(s, s.pending.substr(0, eol));
+            s.pending.erase(0, eol + 1);
+        }
+    }
+
+    static void enterPhase(Slot& s, const std::string& phase)
+    {
+        const double now = seconds();
+        s.outcome.phaseSec[s.phase] += now - s.phaseStarted;
+        s.phase = phase;
+        s.phaseStarted = now;
+    }
+
+    void finish(Slot& s, int status)
+    {
+        const double now = seconds();
+        s.outcome.phaseSec[s.phase] += now - s.phaseStarted;
+        s.outcome.wallSec = now - s.started;
+        s.outcome.phase = s.phase;
+
+        if (s.aborted) {
+            s.outcome.status = "aborted";
+            s.outcome.message = "batch interrupted";
+        } else if (! s.killedIn.empty()) {
+            s.outcome.status = "timeout";
+            s.outcome.phase = s.killedIn;
+            s.outcome.message = "no progress in " + s.killedIn + " for "
+                                + String(cfg_.timeouts.forPhase(s.killedIn)).toStdString() + " s; killed";
+        } else if (WIFSIGNALED(status)) {
+            s.outcome.status = "crash";
+            s.outcome.signal = WTERMSIG(status);
+            s.outcome.message = std::string(strsignal(s.outcome.signal));
+            const auto last = lastLogLine(s.logPath);
+            if (! last.empty()) s.outcome.message += ": " + last;
+        } else if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+            s.outcome.status = "exit";
+            s.outcome.exitCode = WEXITSTATUS(status);
+            s.outcome.message = lastLogLine(s.logPath);
+        } else {
+            s.outcome.status = "ok";
+        }
+
+        ::close(s.phaseFd);
+        s.phaseFd = -1;
+        s.pid = -1;
+    }
+
+    /** Last non-debug line of a worker log, for the failure record. */
+    static std::string lastLogLine(const std::string& path)
+    {
+        FileInputStream in { File(path) };
+        if (! in.openedOk()) return {};
+        in.setPosition(jmax<int64>(0, in.getTotalLength() - 4096));
+
+        StringArray lines;
+        lines.addLines(in.readEntireStreamAsString());
+        for (int i = lines.size(); --i >= 0;) {
+            const auto line = lines[i].trim();
+            if (line.isNotEmpty() && ! line.startsWith("[DEBUG]"))
+                return line.substring(0, 200).toStdString();
+        }
+        return {};
+    }
+
+    WorkerPoolConfig cfg_;
+    std::vector<Slot> slots_;
+};
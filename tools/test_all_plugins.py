@@ -4,6 +4,8 @@ test_all_plugins.py — Batch test all VST3 plugins in system folder
 
 Scans the system VST3 plugins folder and runs performance tests on each plugin.
 Results are saved to individual CSV files and a summary report is generated.
+Plugins run one after another; for crash-isolated, concurrent runs with
+per-phase watchdogs use the native plugperf-batch runner instead.
 
 Usage:
   python tools/test_all_plugins.py [options]
@@ -14,9 +16,10 @@ Options:
   --buffers SIZES          Comma-separated buffer sizes (default: 64,256,1024,4096)
   --iterations N           Number of iterations per buffer (default: 200)
   --warmup N               Number of warmup iterations (default: 40)
-  --sr RATE                Sample rate (default: 48000)
-  --channels N             Channel count (default: 2)
-  --bits DEPTH             Bit depth: 32f or 64f (default: 32f)
+  --sr RATE                Sample rate(s), comma-separated (default: 48000)
+  --channels N             Channel count(s), comma-separated (default: 2)
+  --bits DEPTH             Bit depth(s): 32f and/or 64f (default: 32f)
+                           Lists run as one matrix per plugin process
   --skip-errors            Continue testing even if a plugin fails
   --parallel N             Number of plugins to test in parallel (default: 1)
 """
@@ -43,16 +46,40 @@ def format_time(seconds):
         mins = int((seconds % 3600) // 60)
         return f"{hours}h {mins}m"
 
+def count_cells(args):
+    """Number of (sample rate, channels, bit depth) combinations per plugin run."""
+    return (len(args.sr.split(',')) * len(args.channels.split(','))
+            * len(args.bits.split(',')))
+
 def estimate_time_per_plugin(args):
     """Estimate time per plugin in seconds."""
     buffer_count = len(args.buffers.split(','))
     iterations_per_buffer = args.warmup + args.iterations
-    # Rough estimate: ~0.5ms per iteration average
-    estimated = buffer_count * iterations_per_buffer * 0.0005
+    # Rough estimate: ~0.5ms per iteration average, for every matrix cell
+    estimated = count_cells(args) * buffer_count * iterations_per_buffer * 0.0005
     # Add overhead for plugin loading/unloading
     estimated += 5
     return int(estimated)
 
+def summarise_cells(rows):
+    """Per (sr, channel layout, bit_depth) cell: buffer sizes measured, mean DSP load and CV."""
+    cells = {}
+    for r in rows:
+        cells.setdefault((r['sr'], r['channel_layout'], r['bit_depth']), []).append(r)
+
+    summary = []
+    for (sr, layout, bit_depth), cell_rows in cells.items():
+        summary.append({
+            'sr': sr,
+            'channel_layout': layout,
+            'channels': cell_rows[0]['channels'],
+            'bit_depth': bit_depth,
+            'buffer_count': len({r['block_size'] for r in cell_rows}),
+            'mean_dsp_load': sum(float(r['dsp_load_pct']) for r in cell_rows) / len(cell_rows),
+            'mean_cv': sum(float(r['cv_pct']) for r in cell_rows) / len(cell_rows)
+        })
+    return summary
+
 def estimate_total_time(plugin_count, args):
     """Estimate total batch test time."""
     per_plugin = estimate_time_per_plugin(args)
@@ -105,9 +132,13 @@ def test_plugin(plugperf_bin, plugin_path, output_file, args):
     
     buffer_sizes = args.buffers.split(',')
     total_buffers = len(buffer_sizes)
+    cells = count_cells(args)
+    # The fixed limit was sized for one cell; a matrix run gets it per cell
+    timeout = 300 * cells
     
     print(f"  Plugin: {plugin_path.name}")
-    print(f"  Config: {args.channels}ch, {args.sr}Hz, {args.bits}, {total_buffers} buffer sizes")
+    print(f"  Config: {args.channels}ch, {args.sr}Hz, {args.bits}, {total_buffers} buffer sizes"
+          + (f", {cells} cells" if cells > 1 else ""))
     print(f"  Buffers: {args.buffers}")
     print(f"  Iterations: {args.warmup} warmup + {args.iterations} timed per buffer")
     print(f"  Output: {output_file.name}")
@@ -139,10 +170,10 @@ def test_plugin(plugperf_bin, plugin_path, output_file, args):
                 print(f"  Status: Testing{dot_str} ({elapsed:.0f}s elapsed)", flush=True)
                 last_update = current_time
             
-            # Check for timeout (5 minutes)
-            if elapsed > 300:
+            # Check for timeout (5 minutes per cell)
+            if elapsed > timeout:
                 process.kill()
-                print(f"  ✗ Timeout (>5 minutes)")
+                print(f"  ✗ Timeout (>{timeout // 60} minutes)")
                 return False, "Timeout"
             
             time.sleep(0.5)
@@ -160,10 +191,9 @@ def test_plugin(plugperf_bin, plugin_path, output_file, args):
                     with open(output_file, 'r') as f:
                         reader = csv.DictReader(f)
                         rows = list(reader)
-                        if rows:
-                            avg_dsp = sum(float(r['dsp_load_pct']) for r in rows) / len(rows)
-                            avg_cv = sum(float(r['cv_pct']) for r in rows) / len(rows)
-                            print(f"  Results: Avg DSP {avg_dsp:.2f}%, Avg CV {avg_cv:.2f}%")
+                        for cell in summarise_cells(rows):
+                            print(f"  Results {cell['sr']}Hz {cell['channel_layout']} {cell['bit_depth']}: "
+                                  f"Avg DSP {cell['mean_dsp_load']:.2f}%, Avg CV {cell['mean_cv']:.2f}%")
                 except:
                     pass
             
@@ -191,18 +221,11 @@ def load_results(csv_file):
             if not rows:
                 return None
             
-            # Calculate summary statistics
-            mean_dsp_load = sum(float(r['dsp_load_pct']) for r in rows) / len(rows)
-            mean_cv = sum(float(r['cv_pct']) for r in rows) / len(rows)
-            
+            # Summary statistics per matrix cell
             return {
                 'plugin_name': rows[0]['plugin_name'],
                 'format': rows[0]['format'],
-                'channels': rows[0]['channels'],
-                'bit_depth': rows[0]['bit_depth'],
-                'buffer_count': len(rows),
-                'mean_dsp_load': mean_dsp_load,
-                'mean_cv': mean_cv,
+                'cells': summarise_cells(rows),
                 'rows': rows
             }
     except Exception as e:
@@ -228,12 +251,14 @@ def generate_summary_report(output_dir, results):
         if results['successful']:
             f.write("SUCCESSFUL TESTS\n")
             f.write("-" * 90 + "\n")
-            f.write(f"{'Plugin':<50} {'Avg DSP%':<12} {'Avg CV%':<12} {'Buffers':<10}\n")
+            f.write(f"{'Plugin':<40} {'Cell':<18} {'Avg DSP%':<10} {'Avg CV%':<10} {'Buffers':<8}\n")
             f.write("-" * 90 + "\n")
             
             for plugin_name, data in sorted(results['successful'].items()):
-                f.write(f"{plugin_name:<50} {data['mean_dsp_load']:<12.2f} "
-                       f"{data['mean_cv']:<12.2f} {data['buffer_count']:<10}\n")
+                for cell in data['cells']:
+                    label = f"{cell['sr']}/{cell['channel_layout']}/{cell['bit_depth']}"
+                    f.write(f"{plugin_name:<40} {label:<18} {cell['mean_dsp_load']:<10.2f} "
+                           f"{cell['mean_cv']:<10.2f} {cell['buffer_count']:<8}\n")
             f.write("\n")
         
         if results['failed']:
@@ -262,12 +287,12 @@ def main():
                        help="Number of iterations per buffer")
     parser.add_argument("--warmup", type=int, default=40,
                        help="Number of warmup iterations")
-    parser.add_argument("--sr", type=int, default=48000,
-                       help="Sample rate")
-    parser.add_argument("--channels", type=int, default=2,
-                       help="Channel count")
+    parser.add_argument("--sr", default="48000",
+                       help="Sample rate, or a comma-separated list")
+    parser.add_argument("--channels", default="2",
+                       help="Channel count, or a comma-separated list")
     parser.add_argument("--bits", default="32f",
-                       help="Bit depth (32f or 64f)")
+                       help="Bit depth (32f or 64f), or a comma-separated list")
     parser.add_argument("--skip-errors", action="store_true",
                        help="Continue testing even if a plugin fails")
     
@@ -49,13 +49,14 @@ def run_benchmark(plugperf_path: Path,
                   preset_path: Path,
                   output_csv: Path,
                   buffers: List[int],
-                  sample_rate: int = 48000,
-                  channels: int = 2,
+                  sample_rate: str = "48000",
+                  channels: str = "2",
                   warmup: int = 40,
                   iterations: int = 400,
                   bit_depth: str = "32f") -> bool:
     """
-    Run plugperf benchmark with a specific preset.
+    Run plugperf benchmark with a specific preset. sample_rate, channels and
+    bit_depth may be comma-separated lists; plugperf runs them as one matrix.
     
     Returns:
         True if benchmark succeeded, False otherwise
@@ -73,12 +74,16 @@ def run_benchmark(plugperf_path: Path,
         "--out", str(output_csv)
     ]
     
+    # 5 minutes per (sr, channels, bits) cell of the matrix
+    cells = len(sample_rate.split(",")) * len(channels.split(",")) * len(bit_depth.split(","))
+    timeout = 300 * cells
+
     try:
         result = subprocess.run(
             cmd,
             capture_output=True,
             text=True,
-            timeout=300  # 5 minute timeout per preset
+            timeout=timeout
         )
         
         if result.returncode != 0:
@@ -93,7 +98,7 @@ def run_benchmark(plugperf_path: Path,
             return True  # Still count as success if benchmark ran
             
     except subprocess.TimeoutExpired:
-        print(f"  ✗ Benchmark timed out (>5 minutes)")
+        print(f"  ✗ Benchmark timed out (>{timeout // 60} minutes)")
         return False
     except Exception as e:
         print(f"  ✗ Error running benchmark: {e}")
@@ -191,9 +196,9 @@ Examples:
     parser.add_argument("--output-dir", required=True, help="Output directory for results")
     parser.add_argument("--plugperf", default="./build/plugperf", help="Path to plugperf binary")
     parser.add_argument("--buffers", default="64,256,512,1024,2048,4096", help="Comma-separated buffer sizes")
-    parser.add_argument("--sr", type=int, default=48000, help="Sample rate (default: 48000)")
-    parser.add_argument("--channels", type=int, default=2, help="Channel count (default: 2)")
-    parser.add_argument("--bits", default="32f", choices=["32f", "64f"], help="Bit depth (default: 32f)")
+    parser.add_argument("--sr", default="48000", help="Sample rate, or a comma-separated list (default: 48000)")
+    parser.add_argument("--channels", default="2", help="Channel count, or a comma-separated list (default: 2)")
+    parser.add_argument("--bits", default="32f", help="Bit depth (32f or 64f), or a comma-separated list (default: 32f)")
     parser.add_argument("--warmup", type=int, default=40, help="Warmup iterations (default: 40)")
     parser.add_argument("--iterations", type=int, default=400, help="Timed iterations (default: 400)")
     parser.add_argument("--pattern", default="*.json", help="Preset file pattern (default: *.json)")